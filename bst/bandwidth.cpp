@@ -0,0 +1,303 @@
+#include "bst/benchmarks.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+#include "bst/simd.h"
+#include "bst/stats.h"
+
+namespace bst {
+
+// ---------------- Random index generators ----------------
+// Generators for the random-access kernel. Each is constructed with a seed
+// and a range and returns indices in [0, range). mt19937_64 with
+// uniform_int_distribution is the original; the others are a few ALU ops
+// with multiply-shift range reduction, cheap enough that a cache-resident
+// random run measures memory rather than the PRNG.
+static inline std::uint64_t mul_hi64(std::uint64_t a, std::uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 u128;
+    return static_cast<std::uint64_t>((static_cast<u128>(a) * b) >> 64);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    return __umulh(a, b);
+#else
+    const std::uint64_t a_lo = a & 0xFFFFFFFFu, a_hi = a >> 32;
+    const std::uint64_t b_lo = b & 0xFFFFFFFFu, b_hi = b >> 32;
+    const std::uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo;
+    const std::uint64_t lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+    const std::uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFFu) + lo_hi;
+    return hi_hi + (hi_lo >> 32) + (cross >> 32);
+#endif
+}
+
+struct MtIndex {
+    std::mt19937_64 rng;
+    std::uniform_int_distribution<size_t> dist;
+    MtIndex(std::uint64_t seed, size_t range) : rng(seed), dist(0, range - 1) {}
+    size_t operator()() { return dist(rng); }
+};
+
+// Marsaglia xorshift64* (state must be non-zero)
+struct XorshiftIndex {
+    std::uint64_t s;
+    std::uint64_t range;
+    XorshiftIndex(std::uint64_t seed, size_t r) : s(seed ? seed : 0x9E3779B97F4A7C15ull), range(r) {}
+    size_t operator()() {
+        s ^= s >> 12;
+        s ^= s << 25;
+        s ^= s >> 27;
+        return static_cast<size_t>(mul_hi64(s * 0x2545F4914F6CDD1Dull, range));
+    }
+};
+
+// Steele/Lea/Flood SplitMix64
+struct SplitmixIndex {
+    std::uint64_t s;
+    std::uint64_t range;
+    SplitmixIndex(std::uint64_t seed, size_t r) : s(seed), range(r) {}
+    size_t operator()() {
+        std::uint64_t z = (s += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return static_cast<size_t>(mul_hi64(z ^ (z >> 31), range));
+    }
+};
+
+// Wang Yi's wyrand
+struct WyrandIndex {
+    std::uint64_t s;
+    std::uint64_t range;
+    WyrandIndex(std::uint64_t seed, size_t r) : s(seed), range(r) {}
+    size_t operator()() {
+        s += 0xA0761D6478BD642Full;
+        const std::uint64_t t = s ^ 0xE7037ED1A0B428DBull;
+        return static_cast<size_t>(mul_hi64(mul_hi64(s, t) ^ (s * t), range));
+    }
+};
+
+// Random read/xor/write at cnt generated indices in [begin, begin + cnt).
+template <typename Gen>
+static std::uint64_t random_pass(std::uint64_t* buf, size_t begin, size_t cnt, Gen& gen) {
+    std::uint64_t sum = 0;
+    for (size_t k = 0; k < cnt; ++k) {
+        const size_t i = begin + gen();
+        std::uint64_t v = buf[i];
+        sum += (v + 0x9E3779B97F4A7C15ull);
+        buf[i] = v ^ XOR_RAND_MASK;
+    }
+    return sum;
+}
+
+// Same access sequence replayed from a pre-generated stream of offsets.
+static std::uint64_t random_pass_indexed(std::uint64_t* buf, size_t begin,
+                                         const std::vector<std::uint32_t>& idx) {
+    std::uint64_t sum = 0;
+    for (const std::uint32_t off : idx) {
+        const size_t i = begin + off;
+        std::uint64_t v = buf[i];
+        sum += (v + 0x9E3779B97F4A7C15ull);
+        buf[i] = v ^ XOR_RAND_MASK;
+    }
+    return sum;
+}
+
+// Sets up Gen outside the timed region, waits on the gate, then runs
+// `passes` random passes over [begin, end), or with `seconds` > 0 as many
+// passes as fit before that long after the gate opened (the deadline is
+// checked once per pass). With pregen, one pass worth of indices is
+// generated up front and replayed on every pass. Returns the pass count.
+template <typename Gen>
+static std::uint64_t random_passes(std::uint64_t* buf, size_t begin, size_t end, int passes,
+                                   double seconds, std::uint64_t seed, bool pregen,
+                                   StartGate& gate, ProgressLog& progress, std::uint64_t& sum) {
+    const size_t cnt = end - begin;
+    Gen gen(seed, cnt);
+    std::vector<std::uint32_t> idx;
+    if (pregen) {
+        idx.resize(cnt);
+        for (auto& i : idx) i = static_cast<std::uint32_t>(gen());
+    }
+
+    gate.wait();
+
+    const Clock::time_point deadline = gate.released_at + to_clock(seconds);
+    const std::uint64_t pass_bytes = cnt * sizeof(std::uint64_t) * 2ull;
+    std::uint64_t done = 0;
+    for (; seconds > 0 ? Clock::now() < deadline : done < static_cast<std::uint64_t>(passes); ++done) {
+        sum += pregen ? random_pass_indexed(buf, begin, idx) : random_pass(buf, begin, cnt, gen);
+        progress.add((done + 1) * pass_bytes);
+    }
+    return done;
+}
+
+// ---------------- Bandwidth ----------------
+std::uint64_t kernel_pass(const Config& cfg, const Runtime& rt, Buffers& bufs,
+                          size_t begin, size_t end, std::uint64_t& sum) {
+    rt.kernel->pass(cfg, rt.vec, bufs, begin, end, sum);
+    return (end - begin) * static_cast<std::uint64_t>(rt.kernel->streams) * sizeof(std::uint64_t) /
+           static_cast<std::uint64_t>(rt.kernel->stride);
+}
+
+std::uint64_t stream_checksum(const Buffers& bufs, size_t i) {
+    std::uint64_t sum = 0;
+    for (const PageArray<double>* arr : {&bufs.a, &bufs.b, &bufs.c}) {
+        std::uint64_t v;
+        std::memcpy(&v, &(*arr)[i], sizeof(v));
+        sum ^= v;
+    }
+    return sum;
+}
+
+std::uint64_t rfo_share(const Config& cfg, const KernelInfo& kernel, std::uint64_t bytes) {
+    return cfg.nt_stores ? 0 : bytes / static_cast<std::uint64_t>(kernel.streams) *
+                               static_cast<std::uint64_t>(kernel.rfo);
+}
+
+// Duration runs check the deadline after every chunk of this many words.
+static const size_t DURATION_CHUNK_WORDS = 1 << 16; // 512 KiB
+
+Measurement run_bandwidth(const Config& cfg, const Runtime& rt, Buffers& bufs,
+                          size_t words, int passes, double seconds, WorkerPool* pool) {
+    const bool stream_kernel = (rt.kernel->flags & KERNEL_STREAM) != 0;
+    std::uint64_t* buf = bufs.buf.data();
+
+    // Partition work per thread
+    const size_t words_per_thread = (words + cfg.threads - 1) / cfg.threads;
+
+    auto worker = [&](int tid, StartGate& gate, ThreadResult& result) {
+        const size_t begin = std::min(words, static_cast<size_t>(tid) * words_per_thread);
+        const size_t end   = std::min(words, begin + words_per_thread);
+        if (begin >= end) {
+            gate.wait();
+            return;
+        }
+
+        std::uint64_t local_sum = 0;
+        std::uint64_t bytes = 0;
+
+        if (cfg.random_access) {
+            // Random accesses of equal count, one index generator per thread
+            const std::uint64_t seed = cfg.seed ^ (static_cast<std::uint64_t>(tid) << 32);
+            std::uint64_t done = 0;
+            switch (cfg.rng) {
+            case Rng::Mt:
+                done = random_passes<MtIndex>(buf, begin, end, passes, seconds, seed, cfg.pregen,
+                                              gate, result.progress, local_sum);
+                break;
+            case Rng::Xorshift:
+                done = random_passes<XorshiftIndex>(buf, begin, end, passes, seconds, seed, cfg.pregen,
+                                                    gate, result.progress, local_sum);
+                break;
+            case Rng::Splitmix:
+                done = random_passes<SplitmixIndex>(buf, begin, end, passes, seconds, seed, cfg.pregen,
+                                                    gate, result.progress, local_sum);
+                break;
+            case Rng::Wyrand:
+                done = random_passes<WyrandIndex>(buf, begin, end, passes, seconds, seed, cfg.pregen,
+                                                  gate, result.progress, local_sum);
+                break;
+            }
+            bytes = done * (end - begin) * sizeof(std::uint64_t) * 2ull;
+        } else {
+            // Wait for synchronized start
+            gate.wait();
+
+            // Main loop
+            if (seconds > 0) {
+                const Clock::time_point deadline = gate.released_at + to_clock(seconds);
+                size_t i = begin;
+                while (Clock::now() < deadline) {
+                    const size_t stop = std::min(end, i + DURATION_CHUNK_WORDS);
+                    bytes += kernel_pass(cfg, rt, bufs, i, stop, local_sum);
+                    result.progress.add(bytes);
+                    i = stop == end ? begin : stop;
+                }
+            } else {
+                for (int it = 0; it < passes; ++it) {
+                    bytes += kernel_pass(cfg, rt, bufs, begin, end, local_sum);
+                    result.progress.add(bytes);
+                }
+            }
+        }
+
+        if (stream_kernel) local_sum = stream_checksum(bufs, begin);
+
+        result.bytes_processed = bytes;
+        result.rfo_bytes = rfo_share(cfg, *rt.kernel, bytes);
+        result.checksum = local_sum; // make side effects observable
+    };
+    return pool ? pool->run(worker) : run_threads(rt, cfg.threads, worker);
+}
+
+// ---------------- Repeated trials ----------------
+// Each trial runs --iterations passes (or --duration). With --target-ci
+// trials are added until the confidence interval is tight enough or
+// --max-trials is reached.
+std::vector<Measurement> run_trials(const Config& cfg, const Runtime& rt, Buffers& bufs, size_t words) {
+    WorkerPool pool(rt, cfg.threads);
+    if (cfg.warmup > 0) run_bandwidth(cfg, rt, bufs, words, cfg.warmup, 0.0, &pool);
+
+    std::vector<Measurement> trials;
+    const int min_trials = cfg.target_ci > 0 ? std::max(cfg.trials, 2) : cfg.trials;
+    for (;;) {
+        trials.push_back(run_bandwidth(cfg, rt, bufs, words, cfg.iterations, cfg.duration, &pool));
+        const int n = static_cast<int>(trials.size());
+        if (n < min_trials) continue;
+        if (cfg.target_ci <= 0 || n >= cfg.max_trials) break;
+        if (trial_stats(trials).ci_percent() <= cfg.target_ci) break;
+    }
+    return trials;
+}
+
+// ---------------- Thread scaling ----------------
+// Thread counts 1..max, either every count or powers of two (max is always
+// included).
+static std::vector<int> scale_steps(int max_threads, bool pow2) {
+    std::vector<int> steps;
+    for (int t = 1; t < max_threads; t = pow2 ? t * 2 : t + 1) steps.push_back(t);
+    steps.push_back(max_threads);
+    return steps;
+}
+
+// Runs the kernel at each thread count over the same buffers, reusing the
+// CPU plan made for the largest count so step k runs on its first k CPUs.
+// The saturation point is the smallest count within --scale-tolerance of
+// the peak: beyond it, extra threads buy (almost) no bandwidth.
+void run_scale(const Config& cfg, const Runtime& rt, Buffers& bufs, size_t words) {
+    struct Step { int threads; double mbps; };
+    std::vector<Step> steps;
+
+    std::cout << std::setw(8) << "Threads" << std::setw(20) << "Bandwidth (MB/s)"
+              << std::setw(20) << "Per thread (MB/s)" << std::setw(16) << "Efficiency (%)" << "\n";
+    double single = 0.0;
+    for (int n : scale_steps(cfg.threads, cfg.scale_pow2)) {
+        Config step_cfg = cfg;
+        step_cfg.threads = n;
+        Runtime step_rt = rt;
+        if (!step_rt.cpus.empty()) step_rt.cpus.resize(n);
+
+        const double mbps = run_bandwidth(step_cfg, step_rt, bufs, words, cfg.iterations, cfg.duration).mbps();
+        if (n == 1) single = mbps;
+        const double per_thread = mbps / n;
+        steps.push_back({n, mbps});
+
+        std::cout << std::setw(8) << n << std::setw(20) << mbps << std::setw(20) << per_thread
+                  << std::setw(16) << (single > 0 ? per_thread / single * 100.0 : 0.0) << std::endl;
+    }
+
+    double peak = 0.0;
+    for (const auto& s : steps) peak = std::max(peak, s.mbps);
+    for (const auto& s : steps) {
+        if (s.mbps >= peak * (1.0 - cfg.scale_tolerance / 100.0)) {
+            std::cout << "\nSaturation point      : " << s.threads << " thread(s) reach "
+                      << s.mbps << " MB/s, within " << cfg.scale_tolerance
+                      << "% of the peak " << peak << " MB/s\n";
+            break;
+        }
+    }
+}
+
+} // namespace bst
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "bst/buffer.h"
+#include "bst/config.h"
+#include "bst/kernel.h"
+#include "bst/runner.h"
+
+namespace bst {
+
+// ---------------- Bandwidth ----------------
+// One sequential pass of rt.kernel over [begin, end). Returns bytes moved;
+// the kernel's checksum contribution is folded into sum.
+std::uint64_t kernel_pass(const Config& cfg, const Runtime& rt, Buffers& bufs,
+                          size_t begin, size_t end, std::uint64_t& sum);
+
+// Fold the written STREAM arrays into the checksum so the stores stay live.
+std::uint64_t stream_checksum(const Buffers& bufs, size_t i);
+
+// Read-for-ownership traffic implied by `bytes` of `kernel` traffic.
+std::uint64_t rfo_share(const Config& cfg, const KernelInfo& kernel, std::uint64_t bytes);
+
+// Runs rt.kernel over the first `words` words of each buffer, split evenly
+// across the threads: `passes` passes per thread or, with `seconds` > 0,
+// until that long after the gate opened, counting the bytes actually
+// moved. Runs on `pool` when given (repeated trials), otherwise on fresh
+// threads.
+Measurement run_bandwidth(const Config& cfg, const Runtime& rt, Buffers& bufs,
+                          size_t words, int passes, double seconds = 0.0,
+                          WorkerPool* pool = nullptr);
+
+// Runs --warmup untimed passes, then --trials measured runs (more with
+// --target-ci) on one pool of threads over the same buffers.
+std::vector<Measurement> run_trials(const Config& cfg, const Runtime& rt, Buffers& bufs, size_t words);
+
+// Bandwidth at 1..cfg.threads threads and the saturation point, as a table.
+void run_scale(const Config& cfg, const Runtime& rt, Buffers& bufs, size_t words);
+
+// ---------------- Latency ----------------
+// Threads a random cycle through the first `words` words of buf and has
+// every thread take `steps` dependent loads from its own starting point.
+Measurement run_latency(const Config& cfg, const Runtime& rt, Buffers& bufs,
+                        size_t words, size_t steps);
+
+// Latency of the probe threads against the bandwidth of the others, one
+// table row per --inject-delays value.
+void run_loaded(const Config& cfg, const Runtime& rt, Buffers& bufs, size_t words);
+
+// Bandwidth and latency over growing working sets, as a table.
+void run_sweep(const Config& cfg, const Runtime& rt, Buffers& bufs);
+
+// ---------------- GUPS (HPCC RandomAccess) ----------------
+static const double GUPS_ERROR_TOLERANCE = 0.01;
+
+// 4 * 2^log2_size updates of a 2^log2_size-word table at the start of buf.
+Measurement run_gups(const Config& cfg, const Runtime& rt, Buffers& bufs, unsigned log2_size);
+
+// Serial verification pass; returns the number of wrong table words.
+std::uint64_t gups_verify(Buffers& bufs, unsigned log2_size);
+
+// Largest n with 2^n words fitting in `bytes`.
+unsigned gups_default_log2(size_t bytes);
+
+// ---------------- False sharing ----------------
+static const std::uint64_t FS_INCREMENTS = 1ull << 20;   // per thread and iteration
+
+// Counter increments per second at every --fs-distances value, as a table.
+void run_false_sharing(const Config& cfg, const Runtime& rt);
+
+} // namespace bst
@@ -0,0 +1,239 @@
+#include "bst/buffer.h"
+
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "bst/runner.h"
+#include "bst/topology.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bst {
+
+#if defined(__linux__)
+#if !defined(MAP_HUGE_SHIFT)
+#define MAP_HUGE_SHIFT 26
+#endif
+
+#if !defined(MADV_POPULATE_WRITE)
+#define MADV_POPULATE_WRITE 23   // Linux 5.14
+#endif
+
+void* map_pages(size_t& bytes, Pages& pages, bool populate) {
+    const size_t want = bytes;
+    for (;;) {
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+        // THP must be advised before the pages are faulted in, so it
+        // populates after madvise() instead
+        if (populate && pages != Pages::Thp) flags |= MAP_POPULATE;
+        size_t align = BASE_PAGE_BYTES;
+        if (pages == Pages::Huge1G || pages == Pages::Huge2M) {
+            align = pages == Pages::Huge1G ? HUGE_PAGE_1G : HUGE_PAGE_2M;
+            flags |= MAP_HUGETLB | ((pages == Pages::Huge1G ? 30 : 21) << MAP_HUGE_SHIFT);
+        } else if (pages == Pages::Thp) {
+            align = HUGE_PAGE_2M;
+        }
+        bytes = (want + align - 1) / align * align;
+
+        if (pages == Pages::Thp) {
+            // Over-map by one huge page and trim, so the range starts on a
+            // 2 MiB boundary and every 2 MiB of it can become a huge page
+            void* raw = mmap(nullptr, bytes + align, PROT_READ | PROT_WRITE, flags, -1, 0);
+            if (raw == MAP_FAILED) return nullptr;
+            char* base = static_cast<char*>(raw);
+            char* p = reinterpret_cast<char*>((reinterpret_cast<std::uintptr_t>(base) + align - 1) / align * align);
+            if (p > base) munmap(base, p - base);
+            if (p + bytes < base + bytes + align) munmap(p + bytes, base + bytes + align - (p + bytes));
+            madvise(p, bytes, MADV_HUGEPAGE);
+            if (populate && madvise(p, bytes, MADV_POPULATE_WRITE) != 0) {
+                std::cerr << "Warning: madvise(MADV_POPULATE_WRITE) failed (" << std::strerror(errno)
+                          << "); faulting pages in by touch\n";
+                for (size_t off = 0; off < bytes; off += BASE_PAGE_BYTES) p[off] = 0;
+            }
+            return p;
+        }
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (p != MAP_FAILED) return p;
+        if (pages == Pages::Default) return nullptr;
+        pages = pages == Pages::Huge1G ? Pages::Huge2M : Pages::Thp;
+    }
+}
+#else
+void* map_pages(size_t& bytes, Pages& pages, bool populate) {
+    (void)populate;
+    pages = Pages::Default;
+    bytes = (bytes + BASE_PAGE_BYTES - 1) / BASE_PAGE_BYTES * BASE_PAGE_BYTES;
+    return ::operator new(bytes, std::align_val_t(BASE_PAGE_BYTES), std::nothrow);
+}
+#endif
+
+void unmap_pages(void* p, size_t bytes) {
+#if defined(__linux__)
+    munmap(p, bytes);
+#else
+    (void)bytes;
+    ::operator delete(p, std::align_val_t(BASE_PAGE_BYTES));
+#endif
+}
+
+PageBacking read_page_backing(const void* p, size_t bytes) {
+    PageBacking pb;
+#if defined(__linux__)
+    std::ifstream in("/proc/self/smaps");
+    const std::uintptr_t lo = reinterpret_cast<std::uintptr_t>(p), hi = lo + bytes;
+    bool inside = false;
+    std::string line;
+    while (std::getline(in, line)) {
+        // VMA header: "start-end perms offset dev inode [path]"
+        const size_t dash = line.find('-');
+        if (dash != std::string::npos && dash > 0 && std::isxdigit(static_cast<unsigned char>(line[0])) &&
+            line.find(':') > line.find(' ')) {
+            const std::uintptr_t start = std::stoull(line.substr(0, dash), nullptr, 16);
+            const std::uintptr_t end = std::stoull(line.substr(dash + 1), nullptr, 16);
+            inside = start < hi && end > lo;
+            continue;
+        }
+        if (!inside) continue;
+        std::istringstream fields(line);
+        std::string name;
+        size_t kb = 0;
+        if (!(fields >> name >> kb)) continue;
+        if (name == "KernelPageSize:") {
+            pb.kernel_page = std::max(pb.kernel_page, kb * 1024);
+            pb.known = true;
+        } else if (name == "Rss:") {
+            pb.rss += kb * 1024;
+        } else if (name == "AnonHugePages:") {
+            pb.thp += kb * 1024;
+        }
+    }
+#else
+    (void)p; (void)bytes;
+#endif
+    return pb;
+}
+
+#if defined(__linux__)
+// Raw mbind(2), so the build does not depend on libnuma.
+static bool bind_pages(void* addr, size_t len, int mode, const std::vector<int>& nodes) {
+    if (len == 0) return true;
+    std::vector<unsigned long> mask(1);
+    const size_t bits = 8 * sizeof(unsigned long);
+    for (int n : nodes) {
+        if (static_cast<size_t>(n) / bits >= mask.size()) mask.resize(n / bits + 1, 0);
+        mask[n / bits] |= 1ul << (n % bits);
+    }
+    return syscall(SYS_mbind, addr, len, mode, mask.data(), mask.size() * bits + 1, 0) == 0;
+}
+#endif
+
+#if defined(__linux__)
+static const int MPOL_BIND_MODE       = 2;   // MPOL_BIND from <numaif.h>
+static const int MPOL_INTERLEAVE_MODE = 3;   // MPOL_INTERLEAVE
+#endif
+
+std::uint64_t thread_faults() {
+#if defined(__linux__) && defined(RUSAGE_THREAD)
+    rusage ru;
+    if (getrusage(RUSAGE_THREAD, &ru) == 0)
+        return static_cast<std::uint64_t>(ru.ru_minflt) + static_cast<std::uint64_t>(ru.ru_majflt);
+#endif
+    return 0;
+}
+
+// Applies the --numa policy to one array: interleave binds the whole range
+// round-robin over all nodes; local / remote bind each thread's slice
+// (rounded to the array's pages) to the node of, or the node after, its pinned CPU.
+template <typename T>
+static void bind_array(const Config& cfg, const Runtime& rt, const NumaTopology& numa, PageArray<T>& arr) {
+#if defined(__linux__)
+    if (arr.size() == 0 || cfg.numa == Numa::FirstTouch) return;
+    bool ok = true;
+    if (cfg.numa == Numa::Interleave) {
+        ok = bind_pages(arr.data(), arr.bytes(), MPOL_INTERLEAVE_MODE, numa.nodes);
+    } else {
+        for (int t = 0; t < cfg.threads && ok; ++t) {
+            size_t lo, hi;
+            std::tie(lo, hi) = page_slice(arr, cfg.threads, t);
+            const int local = numa.node_of(rt.cpus[t]);
+            int node = local;
+            if (cfg.numa == Numa::Remote) {
+                const size_t i = std::find(numa.nodes.begin(), numa.nodes.end(), local) - numa.nodes.begin();
+                node = numa.nodes[(i + 1) % numa.nodes.size()];
+            }
+            ok = bind_pages(reinterpret_cast<char*>(arr.data()) + lo, hi - lo, MPOL_BIND_MODE, {node});
+        }
+    }
+    if (!ok)
+        std::cerr << "Warning: mbind failed (" << std::strerror(errno)
+                  << "); falling back to first-touch placement\n";
+#else
+    (void)cfg; (void)rt; (void)numa; (void)arr;
+#endif
+}
+
+Measurement place_buffers(const Config& cfg, const Runtime& rt, const NumaTopology& numa, Buffers& bufs) {
+    bind_array(cfg, rt, numa, bufs.buf);
+    bind_array(cfg, rt, numa, bufs.a);
+    bind_array(cfg, rt, numa, bufs.b);
+    bind_array(cfg, rt, numa, bufs.c);
+
+    Measurement populated;
+    bool use_madvise = cfg.prefault == Prefault::Madvise;
+#if defined(__linux__)
+    if (use_madvise) {
+        std::atomic<int> failure{0};   // errno of a failed call; errno itself is per thread
+        auto populate_slice = [&](auto& arr, int tid) -> std::uint64_t {
+            if (arr.size() == 0) return 0;
+            size_t lo, hi;
+            std::tie(lo, hi) = page_slice(arr, cfg.threads, tid);
+            if (hi > lo && madvise(reinterpret_cast<char*>(arr.data()) + lo, hi - lo, MADV_POPULATE_WRITE) != 0)
+                failure = errno;
+            return hi - lo;
+        };
+        populated = run_threads(rt, cfg.threads, [&](int tid, StartGate& gate, ThreadResult& result) {
+            gate.wait();
+            const std::uint64_t f0 = thread_faults();
+            result.bytes_processed = populate_slice(bufs.buf, tid) + populate_slice(bufs.a, tid) +
+                                     populate_slice(bufs.b, tid) + populate_slice(bufs.c, tid);
+            result.faults = thread_faults() - f0;
+        });
+        if (failure) {
+            std::cerr << "Warning: madvise(MADV_POPULATE_WRITE) failed (" << std::strerror(failure)
+                      << "); faulting pages in by touch\n";
+            use_madvise = false;
+        }
+    }
+#endif
+
+    auto fill_slice = [&](auto& arr, int tid, auto value) -> std::uint64_t {
+        const size_t per   = (arr.size() + cfg.threads - 1) / cfg.threads;
+        const size_t begin = std::min(arr.size(), static_cast<size_t>(tid) * per);
+        const size_t end   = std::min(arr.size(), begin + per);
+        std::fill(arr.data() + begin, arr.data() + end, value);
+        return (end - begin) * sizeof(value);
+    };
+    const Measurement filled = run_threads(rt, cfg.threads, [&](int tid, StartGate& gate, ThreadResult& result) {
+        gate.wait();
+        const std::uint64_t f0 = thread_faults();
+        result.bytes_processed = fill_slice(bufs.buf, tid, std::uint64_t{0}) + fill_slice(bufs.a, tid, 1.0) +
+                                 fill_slice(bufs.b, tid, 2.0) + fill_slice(bufs.c, tid, 0.0);
+        result.faults = thread_faults() - f0;
+    });
+    return use_madvise ? populated : filled;
+}
+
+} // namespace bst
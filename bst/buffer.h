@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#include "bst/config.h"
+#include "bst/platform.h"
+
+namespace bst {
+
+struct Measurement;
+struct NumaTopology;
+struct Runtime;
+
+// ---------------- Memory ----------------
+static const size_t HUGE_PAGE_2M = 2ull << 20;
+static const size_t HUGE_PAGE_1G = 1ull << 30;
+
+// Maps `bytes` (rounded up to the backing's page size) with the requested
+// backing, falling back 1g -> 2m -> thp -> default when the kernel has no
+// huge pages of that size reserved. Returns the mapping, or nullptr, and
+// leaves the backing actually used in `pages`. With `populate` the pages
+// are faulted in by this thread while mapping. Off Linux this is aligned
+// operator new with default pages.
+void* map_pages(size_t& bytes, Pages& pages, bool populate);
+void unmap_pages(void* p, size_t bytes);
+
+// Page-aligned array whose pages are left untouched until first use, so the
+// first write decides which NUMA node backs each page. Anonymous mmap on
+// Linux, optionally backed by transparent or hugetlb huge pages; aligned
+// operator new elsewhere (no placement or page size control there).
+template <typename T>
+class PageArray {
+public:
+    PageArray() = default;
+    explicit PageArray(size_t n, Pages pages = Pages::Default, bool populate = false) : n_(n), pages_(pages) {
+        if (n == 0) return;
+        bytes_ = n * sizeof(T);
+        void* p = map_pages(bytes_, pages_, populate);
+        if (!p) throw std::bad_alloc();
+        p_ = static_cast<T*>(p);
+    }
+    ~PageArray() { release(); }
+
+    PageArray(PageArray&& o) noexcept : p_(o.p_), n_(o.n_), bytes_(o.bytes_), pages_(o.pages_) {
+        o.p_ = nullptr;
+        o.n_ = o.bytes_ = 0;
+    }
+    PageArray& operator=(PageArray&& o) noexcept {
+        if (this != &o) {
+            release();
+            p_ = o.p_;
+            n_ = o.n_;
+            bytes_ = o.bytes_;
+            pages_ = o.pages_;
+            o.p_ = nullptr;
+            o.n_ = o.bytes_ = 0;
+        }
+        return *this;
+    }
+    PageArray(const PageArray&) = delete;
+    PageArray& operator=(const PageArray&) = delete;
+
+    T*       data()       { return p_; }
+    const T* data() const { return p_; }
+    size_t   size() const { return n_; }
+    size_t   bytes() const { return bytes_; }
+    Pages    pages() const { return pages_; }   // backing actually obtained
+    // Granularity of the mapping: ranges passed to mbind() must be
+    // multiples of it.
+    size_t   page_size() const {
+        return pages_ == Pages::Huge1G ? HUGE_PAGE_1G : pages_ == Pages::Huge2M ? HUGE_PAGE_2M : BASE_PAGE_BYTES;
+    }
+    T&       operator[](size_t i)       { return p_[i]; }
+    const T& operator[](size_t i) const { return p_[i]; }
+
+private:
+    void release() {
+        if (!p_) return;
+        unmap_pages(p_, bytes_);
+        p_ = nullptr;
+    }
+
+    T*     p_ = nullptr;
+    size_t n_ = 0;
+    size_t bytes_ = 0;
+    Pages  pages_ = Pages::Default;
+};
+
+// What the kernel actually backs a range with, summed over the
+// /proc/self/smaps entries (VMAs) that overlap it.
+struct PageBacking {
+    bool   known = false;
+    size_t kernel_page = 0;     // KernelPageSize: 4 KiB, or the hugetlb size
+    size_t rss = 0;             // resident bytes
+    size_t thp = 0;             // resident bytes in transparent huge pages
+};
+
+PageBacking read_page_backing(const void* p, size_t bytes);
+
+// Buffers shared by all runs. buf serves the single-buffer kernels and the
+// pointer chase; a, b and c are the STREAM arrays.
+struct Buffers {
+    PageArray<std::uint64_t> buf;
+    PageArray<double> a, b, c;
+};
+
+// Byte range [lo, hi) of thread t's slice of arr, rounded to the array's
+// pages; the last thread takes the remainder.
+template <typename T>
+std::pair<size_t, size_t> page_slice(const PageArray<T>& arr, int threads, int t) {
+    const size_t per = (arr.size() + threads - 1) / threads * sizeof(T);
+    const size_t page = arr.page_size();
+    const size_t lo = std::min(arr.bytes(), static_cast<size_t>(t) * per / page * page);
+    const size_t hi = t + 1 == threads ? arr.bytes()
+        : std::min(arr.bytes(), static_cast<size_t>(t + 1) * per / page * page);
+    return {lo, hi};
+}
+
+// Page faults taken so far by the calling thread.
+std::uint64_t thread_faults();
+
+// Applies the NUMA policy, then has every worker fault in and write the
+// initial values of its own slice, so pages are faulted in by the thread
+// that will use them and, under first-touch, land on that thread's node.
+// Returns the timed first-touch phase: the fill itself for --prefault
+// touch, or the per-thread MADV_POPULATE_WRITE for madvise. With populate
+// the pages were already faulted in by mmap() and the fill only writes.
+Measurement place_buffers(const Config& cfg, const Runtime& rt, const NumaTopology& numa, Buffers& bufs);
+
+} // namespace bst
@@ -0,0 +1,531 @@
+#include "bst/config.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <stdexcept>
+
+#include "bst/json.h"
+#include "bst/kernel.h"
+#include "bst/platform.h"
+#include "bst/simd.h"
+
+namespace bst {
+
+const char* simd_name(Simd s) {
+    switch (s) {
+    case Simd::Auto:   return "auto";
+    case Simd::Scalar: return "scalar";
+    case Simd::SSE2:   return "sse2";
+    case Simd::AVX2:   return "avx2";
+    case Simd::AVX512: return "avx512";
+    }
+    return "?";
+}
+
+int simd_bits(Simd s) {
+    switch (s) {
+    case Simd::SSE2:   return 128;
+    case Simd::AVX2:   return 256;
+    case Simd::AVX512: return 512;
+    default:           return 64;
+    }
+}
+
+const char* rng_name(Rng r) {
+    switch (r) {
+    case Rng::Mt:       return "mt";
+    case Rng::Xorshift: return "xorshift";
+    case Rng::Splitmix: return "splitmix";
+    case Rng::Wyrand:   return "wyrand";
+    }
+    return "?";
+}
+
+const char* affinity_name(Affinity a) {
+    switch (a) {
+    case Affinity::None:    return "none";
+    case Affinity::Compact: return "compact";
+    case Affinity::Scatter: return "scatter";
+    case Affinity::NoSmt:   return "nosmt";
+    case Affinity::List:    return "list";
+    }
+    return "?";
+}
+
+const char* numa_name(Numa n) {
+    switch (n) {
+    case Numa::FirstTouch: return "first-touch";
+    case Numa::Local:      return "local";
+    case Numa::Remote:     return "remote";
+    case Numa::Interleave: return "interleave";
+    }
+    return "?";
+}
+
+const char* pages_name(Pages p) {
+    switch (p) {
+    case Pages::Default: return "default";
+    case Pages::Thp:     return "thp";
+    case Pages::Huge2M:  return "2m";
+    case Pages::Huge1G:  return "1g";
+    }
+    return "?";
+}
+
+const char* prefault_name(Prefault p) {
+    switch (p) {
+    case Prefault::Touch:    return "touch";
+    case Prefault::Populate: return "populate";
+    case Prefault::Madvise:  return "madvise";
+    }
+    return "?";
+}
+
+const char* format_name(Format f) {
+    switch (f) {
+    case Format::Text: return "text";
+    case Format::Json: return "json";
+    case Format::Csv:  return "csv";
+    }
+    return "?";
+}
+
+// ---------------- Option parsing ----------------
+// Decimal, so a leading zero does not switch to octal; with allow_hex a
+// 0x prefix selects hexadecimal.
+std::uint64_t parse_uint(const std::string& key, const std::string& text, bool allow_hex) {
+    if (text.empty() || text[0] == '-')
+        throw std::invalid_argument("invalid value for " + key + ": '" + text + "'");
+    const bool hex = allow_hex && text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X');
+    size_t pos = 0;
+    unsigned long long v = 0;
+    try {
+        v = std::stoull(text, &pos, hex ? 16 : 10);
+    } catch (const std::exception&) {
+        throw std::invalid_argument("invalid value for " + key + ": '" + text + "'");
+    }
+    if (pos != text.size())
+        throw std::invalid_argument("invalid value for " + key + ": '" + text + "'");
+    return v;
+}
+
+// Accepts plain byte counts or binary suffixes: 64K, 512M, 2G, 1GiB, 256KB ...
+size_t parse_size(const std::string& key, const std::string& text) {
+    size_t pos = 0;
+    unsigned long long v = 0;
+    try {
+        if (text.empty() || text[0] == '-') throw std::invalid_argument(text);
+        v = std::stoull(text, &pos, 10);
+    } catch (const std::exception&) {
+        throw std::invalid_argument("invalid size for " + key + ": '" + text + "'");
+    }
+    std::string suffix = text.substr(pos);
+    std::transform(suffix.begin(), suffix.end(), suffix.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    if (suffix.size() > 1 && (suffix.substr(1) == "B" || suffix.substr(1) == "IB"))
+        suffix.resize(1);
+    unsigned shift = 0;
+    if      (suffix.empty() || suffix == "B") shift = 0;
+    else if (suffix == "K") shift = 10;
+    else if (suffix == "M") shift = 20;
+    else if (suffix == "G") shift = 30;
+    else if (suffix == "T") shift = 40;
+    else throw std::invalid_argument("invalid size suffix for " + key + ": '" + text + "'");
+    if (shift && v > (std::numeric_limits<size_t>::max() >> shift))
+        throw std::invalid_argument("size too large for " + key + ": '" + text + "'");
+    return static_cast<size_t>(v) << shift;
+}
+
+bool parse_bool(const std::string& key, const std::string& text) {
+    if (text == "1" || text == "true" || text == "yes" || text == "on")  return true;
+    if (text == "0" || text == "false" || text == "no" || text == "off") return false;
+    throw std::invalid_argument("invalid boolean for " + key + ": '" + text + "'");
+}
+
+int parse_int(const std::string& key, const std::string& text) {
+    const std::uint64_t v = parse_uint(key, text);
+    if (v > static_cast<std::uint64_t>(std::numeric_limits<int>::max()))
+        throw std::invalid_argument("value too large for " + key + ": '" + text + "'");
+    return static_cast<int>(v);
+}
+
+double parse_double(const std::string& key, const std::string& text) {
+    size_t pos = 0;
+    double v = 0.0;
+    try {
+        v = std::stod(text, &pos);
+    } catch (const std::exception&) {
+        pos = 0;
+    }
+    if (pos == 0 || pos != text.size() || !(v >= 0.0) || !std::isfinite(v))
+        throw std::invalid_argument("invalid value for " + key + ": '" + text + "'");
+    return v;
+}
+
+// Seconds, optionally suffixed with "s" or "ms" (e.g. 2, 2.5s, 500ms).
+double parse_seconds(const std::string& key, const std::string& text) {
+    std::string num = text;
+    double scale = 1.0;
+    if (num.size() > 2 && num.compare(num.size() - 2, 2, "ms") == 0) {
+        num.resize(num.size() - 2);
+        scale = 1e-3;
+    } else if (num.size() > 1 && num.back() == 's') {
+        num.pop_back();
+    }
+    return parse_double(key, num) * scale;
+}
+
+std::string trim(const std::string& s) {
+    const char* ws = " \t\r\n";
+    const size_t b = s.find_first_not_of(ws);
+    if (b == std::string::npos) return "";
+    return s.substr(b, s.find_last_not_of(ws) - b + 1);
+}
+
+// CPU lists use the kernel's cpulist syntax: "0,2,4-7".
+std::vector<int> parse_cpu_list(const std::string& key, const std::string& text) {
+    std::vector<int> cpus;
+    std::istringstream in(text);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        item = trim(item);
+        if (item.empty()) continue;
+        const size_t dash = item.find('-');
+        const int lo = parse_int(key, item.substr(0, dash));
+        const int hi = dash == std::string::npos ? lo : parse_int(key, item.substr(dash + 1));
+        if (hi < lo) throw std::invalid_argument("invalid CPU range for " + key + ": '" + item + "'");
+        for (int c = lo; c <= hi; ++c) cpus.push_back(c);
+    }
+    if (cpus.empty()) throw std::invalid_argument("empty CPU list for " + key);
+    return cpus;
+}
+
+// Applies one option given its long name (without leading dashes).
+void apply_option(Config& cfg, const std::string& key, const std::string& value) {
+    if      (key == "threads")    cfg.threads     = parse_int(key, value);
+    else if (key == "size")       cfg.buffer_size = parse_size(key, value);
+    else if (key == "iterations") cfg.iterations  = parse_int(key, value);
+    else if (key == "seed")       cfg.seed        = parse_uint(key, value, true);
+    else if (key == "config")     load_config_file(cfg, value);
+    else if (key == "baseline") {
+        cfg.baseline = value;
+        load_baseline_config(cfg, value);
+    }
+    else if (key == "regression-threshold") cfg.regression_threshold = parse_double(key, value);
+    else if (key == "random")     cfg.random_access = parse_bool(key, value);
+    else if (key == "chained")    cfg.chained       = parse_bool(key, value);
+    else if (key == "nt")         cfg.nt_stores     = parse_bool(key, value);
+    else if (key == "latency")    cfg.latency       = parse_bool(key, value);
+    else if (key == "page-aware") cfg.page_aware    = parse_bool(key, value);
+    else if (key == "sweep")      cfg.sweep         = parse_bool(key, value);
+    else if (key == "sweep-min")  cfg.sweep_min     = parse_size(key, value);
+    else if (key == "sweep-max")  cfg.sweep_max     = parse_size(key, value);
+    else if (key == "sweep-ppo")  cfg.sweep_ppo     = parse_int(key, value);
+    else if (key == "loaded")     cfg.loaded        = parse_bool(key, value);
+    else if (key == "probe-threads") cfg.probe_threads = parse_int(key, value);
+    else if (key == "inject-delays") {
+        cfg.inject_delays.clear();
+        std::istringstream in(value);
+        std::string item;
+        while (std::getline(in, item, ','))
+            cfg.inject_delays.push_back(parse_int(key, trim(item)));
+        if (cfg.inject_delays.empty())
+            throw std::invalid_argument("--inject-delays needs at least one value");
+    }
+    else if (key == "kernel")     cfg.kernel = kernel_info(value).name;
+    else if (key == "simd") {
+        bool found = false;
+        for (Simd s : {Simd::Auto, Simd::Scalar, Simd::SSE2, Simd::AVX2, Simd::AVX512}) {
+            if (value == simd_name(s)) {
+                cfg.simd = s;
+                found = true;
+            }
+        }
+        if (!found) throw std::invalid_argument("unknown SIMD level: '" + value + "'");
+    }
+    else if (key == "pregen")     cfg.pregen        = parse_bool(key, value);
+    else if (key == "gups")       cfg.gups          = parse_bool(key, value);
+    else if (key == "gups-log2")  cfg.gups_log2     = parse_int(key, value);
+    else if (key == "gups-verify") cfg.gups_verify  = parse_bool(key, value);
+    else if (key == "cpus") {
+        cfg.cpu_list = parse_cpu_list(key, value);
+        cfg.affinity = Affinity::List;
+    }
+    else if (key == "affinity") {
+        bool found = false;
+        for (Affinity a : {Affinity::None, Affinity::Compact, Affinity::Scatter, Affinity::NoSmt, Affinity::List}) {
+            if (value == affinity_name(a)) {
+                cfg.affinity = a;
+                found = true;
+            }
+        }
+        if (!found) throw std::invalid_argument("unknown affinity policy: '" + value + "'");
+    }
+    else if (key == "scale")      cfg.scale         = parse_bool(key, value);
+    else if (key == "scale-steps") {
+        if      (value == "linear") cfg.scale_pow2 = false;
+        else if (value == "pow2")   cfg.scale_pow2 = true;
+        else throw std::invalid_argument("unknown scale steps: '" + value + "'");
+    }
+    else if (key == "scale-tolerance") cfg.scale_tolerance = parse_double(key, value);
+    else if (key == "false-sharing") cfg.false_sharing = parse_bool(key, value);
+    else if (key == "per-thread") cfg.per_thread = parse_bool(key, value);
+    else if (key == "counters") cfg.counters = parse_bool(key, value);
+    else if (key == "format") {
+        bool found = false;
+        for (Format f : {Format::Text, Format::Json, Format::Csv}) {
+            if (value == format_name(f)) {
+                cfg.format = f;
+                found = true;
+            }
+        }
+        if (!found) throw std::invalid_argument("unknown output format: '" + value + "'");
+    }
+    else if (key == "output") cfg.output = value;
+    else if (key == "warmup") cfg.warmup = parse_int(key, value);
+    else if (key == "trials") cfg.trials = parse_int(key, value);
+    else if (key == "target-ci") cfg.target_ci = parse_double(key, value);
+    else if (key == "max-trials") cfg.max_trials = parse_int(key, value);
+    else if (key == "duration") cfg.duration = parse_seconds(key, value);
+    else if (key == "fs-distances") {
+        cfg.fs_distances.clear();
+        std::istringstream in(value);
+        std::string item;
+        while (std::getline(in, item, ','))
+            cfg.fs_distances.push_back(parse_size(key, trim(item)));
+        if (cfg.fs_distances.empty())
+            throw std::invalid_argument("--fs-distances needs at least one value");
+    }
+    else if (key == "numa") {
+        bool found = false;
+        for (Numa n : {Numa::FirstTouch, Numa::Local, Numa::Remote, Numa::Interleave}) {
+            if (value == numa_name(n)) {
+                cfg.numa = n;
+                found = true;
+            }
+        }
+        if (!found) throw std::invalid_argument("unknown NUMA policy: '" + value + "'");
+    }
+    else if (key == "pages") {
+        bool found = false;
+        for (Pages p : {Pages::Default, Pages::Thp, Pages::Huge2M, Pages::Huge1G}) {
+            if (value == pages_name(p)) {
+                cfg.pages = p;
+                found = true;
+            }
+        }
+        if (!found) throw std::invalid_argument("unknown page backing: '" + value + "'");
+    }
+    else if (key == "prefault") {
+        bool found = false;
+        for (Prefault p : {Prefault::Touch, Prefault::Populate, Prefault::Madvise}) {
+            if (value == prefault_name(p)) {
+                cfg.prefault = p;
+                found = true;
+            }
+        }
+        if (!found) throw std::invalid_argument("unknown prefault method: '" + value + "'");
+    }
+    else if (key == "rng") {
+        bool found = false;
+        for (Rng r : {Rng::Mt, Rng::Xorshift, Rng::Splitmix, Rng::Wyrand}) {
+            if (value == rng_name(r)) {
+                cfg.rng = r;
+                found = true;
+            }
+        }
+        if (!found) throw std::invalid_argument("unknown generator: '" + value + "'");
+    }
+    else if (key == "pattern") {
+        if      (value == "seq" || value == "sequential") cfg.random_access = false;
+        else if (value == "random" || value == "rand")    cfg.random_access = true;
+        else throw std::invalid_argument("unknown pattern: '" + value + "'");
+    }
+    else throw std::invalid_argument("unknown option: " + key);
+}
+
+// Config file format: one "key = value" per line, '#' starts a comment.
+// Keys are the long option names, e.g. "threads = 16" or "size = 1G".
+void load_config_file(Config& cfg, const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("cannot open config file: " + path);
+    std::string line;
+    int lineno = 0;
+    while (std::getline(in, line)) {
+        ++lineno;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+        const size_t eq = line.find('=');
+        if (eq == std::string::npos)
+            throw std::invalid_argument(path + ":" + std::to_string(lineno) + ": expected key = value");
+        const std::string key = trim(line.substr(0, eq));
+        if (key == "config")
+            throw std::invalid_argument(path + ":" + std::to_string(lineno) + ": nested config files are not supported");
+        apply_option(cfg, key, trim(line.substr(eq + 1)));
+    }
+}
+
+// A "config" member of a result document as an option value string;
+// empty for null and empty lists (option left at its default).
+std::string json_option_value(const JsonValue& v) {
+    switch (v.type) {
+    case JsonValue::Type::Bool:
+        return v.boolean ? "true" : "false";
+    case JsonValue::Type::Number: {
+        std::ostringstream os;
+        os.imbue(std::locale::classic());
+        os << std::setprecision(17) << v.number;
+        return os.str();
+    }
+    case JsonValue::Type::String:
+        return v.str;
+    case JsonValue::Type::Array: {
+        std::string value;
+        for (const JsonValue& item : v.items)
+            value += (value.empty() ? "" : ",") + std::to_string(static_cast<long long>(item.number));
+        return value;
+    }
+    default:
+        return "";
+    }
+}
+
+// Applies the "config" object of a saved --format json result. Its keys
+// are long option names, so later options on the command line override
+// them just like with --config.
+void load_baseline_config(Config& cfg, const std::string& path) {
+    const JsonValue doc = load_json_file(path);
+    const JsonValue* config = doc.get("config");
+    if (!config || config->type != JsonValue::Type::Object)
+        throw std::invalid_argument(path + ": not a result file (no \"config\" object)");
+    for (const auto& m : config->members) {
+        const std::string value = json_option_value(m.second);
+        if (value.empty()) continue;
+        try {
+            apply_option(cfg, m.first, value);
+        } catch (const std::exception& e) {
+            throw std::invalid_argument(path + ": config " + m.first + ": " + e.what());
+        }
+    }
+}
+
+void validate_config(const Config& cfg) {
+    if (cfg.threads < 1)
+        throw std::invalid_argument("threads must be at least 1");
+    if (cfg.iterations < 1)
+        throw std::invalid_argument("iterations must be at least 1");
+    if (cfg.buffer_size < sizeof(std::uint64_t))
+        throw std::invalid_argument("buffer size too small (minimum " +
+                                    std::to_string(sizeof(std::uint64_t)) + " bytes)");
+    const KernelInfo& kernel = kernel_info(cfg.kernel);
+    if (cfg.random_access && !(kernel.flags & KERNEL_RANDOM))
+        throw std::invalid_argument("the " + cfg.kernel + " kernel has no random-access variant");
+    if (static_cast<int>(kernel.isa) > static_cast<int>(detect_simd()))
+        throw std::invalid_argument("the " + cfg.kernel + " kernel needs " + simd_name(kernel.isa) +
+                                    ", which this CPU does not support");
+    if (cfg.simd != Simd::Auto && cfg.simd != Simd::Scalar) {
+        const Simd best = detect_simd();
+        if (best == Simd::Scalar || static_cast<int>(cfg.simd) > static_cast<int>(best))
+            throw std::invalid_argument(std::string("this CPU does not support --simd ") + simd_name(cfg.simd));
+    }
+    if (cfg.sweep) {
+        const size_t hi = cfg.sweep_max ? cfg.sweep_max : cfg.buffer_size;
+        if (cfg.latency)
+            throw std::invalid_argument("--sweep already measures latency; drop --latency");
+        if (cfg.sweep_ppo < 1 || cfg.sweep_ppo > 64)
+            throw std::invalid_argument("--sweep-ppo must be between 1 and 64");
+        if (cfg.sweep_min < CACHE_LINE || cfg.sweep_min > hi)
+            throw std::invalid_argument("--sweep-min must be at least one cache line and at most the largest size");
+    }
+    if (cfg.pregen && cfg.random_access &&
+        cfg.buffer_size / sizeof(std::uint64_t) / cfg.threads > std::numeric_limits<std::uint32_t>::max())
+        throw std::invalid_argument("--pregen supports at most 2^32 words per thread");
+    if (cfg.affinity == Affinity::List && cfg.cpu_list.empty())
+        throw std::invalid_argument("--affinity list needs --cpus");
+    if ((cfg.numa == Numa::Local || cfg.numa == Numa::Remote) && cfg.affinity == Affinity::None)
+        throw std::invalid_argument(std::string("--numa ") + numa_name(cfg.numa) +
+                                    " needs pinned threads (--affinity)");
+    // mbind() only steers pages faulted in after it, and MAP_POPULATE has
+    // faulted every page in on the main thread before placement runs
+    if (cfg.prefault == Prefault::Populate && cfg.numa != Numa::FirstTouch)
+        throw std::invalid_argument(std::string("--prefault populate cannot be combined with --numa ") +
+                                    numa_name(cfg.numa) + "; use madvise");
+#if !defined(__linux__)
+    if (cfg.affinity != Affinity::None)
+        throw std::invalid_argument("thread pinning is only supported on Linux");
+    if (cfg.numa != Numa::FirstTouch)
+        throw std::invalid_argument("NUMA placement is only supported on Linux");
+    if (cfg.pages != Pages::Default)
+        throw std::invalid_argument("huge pages are only supported on Linux");
+    if (cfg.prefault != Prefault::Touch)
+        throw std::invalid_argument("--prefault populate and madvise are only supported on Linux");
+    if (cfg.counters)
+        throw std::invalid_argument("--counters is only supported on Linux");
+#endif
+    if (cfg.trials < 1)
+        throw std::invalid_argument("--trials must be at least 1");
+    if (cfg.target_ci > 0 && cfg.max_trials < std::max(cfg.trials, 2))
+        throw std::invalid_argument("--max-trials must be at least --trials and 2");
+    if ((cfg.trials > 1 || cfg.warmup > 0 || cfg.target_ci > 0) &&
+        (cfg.latency || cfg.sweep || cfg.loaded || cfg.gups || cfg.scale || cfg.false_sharing))
+        throw std::invalid_argument("--warmup, --trials and --target-ci only apply to bandwidth runs");
+    if (cfg.duration > 0 && (cfg.latency || cfg.sweep || cfg.loaded || cfg.gups || cfg.false_sharing))
+        throw std::invalid_argument("--duration only applies to bandwidth runs (including --scale)");
+    if (cfg.format != Format::Text && (cfg.sweep || cfg.loaded || cfg.scale || cfg.false_sharing))
+        throw std::invalid_argument(std::string("--format ") + format_name(cfg.format) +
+                                    " supports bandwidth, latency and GUPS runs");
+    if (!cfg.baseline.empty() && (cfg.sweep || cfg.loaded || cfg.scale || cfg.false_sharing))
+        throw std::invalid_argument("--baseline supports bandwidth, latency and GUPS runs");
+    if (!cfg.output.empty() && cfg.format == Format::Text)
+        throw std::invalid_argument("--output needs --format json or csv");
+    if (cfg.false_sharing) {
+        if (cfg.latency || cfg.sweep || cfg.loaded || cfg.gups || cfg.scale)
+            throw std::invalid_argument("--false-sharing cannot be combined with other modes");
+        for (size_t d : cfg.fs_distances)
+            if (d == 0 || d % sizeof(std::uint64_t) != 0 || d > (1u << 20))
+                throw std::invalid_argument("--fs-distances must be multiples of 8 bytes up to 1M");
+    }
+    if (cfg.scale) {
+        if (cfg.latency || cfg.sweep || cfg.loaded || cfg.gups)
+            throw std::invalid_argument("--scale cannot be combined with other modes");
+        if (cfg.scale_tolerance >= 100.0)
+            throw std::invalid_argument("--scale-tolerance must be below 100");
+    }
+    if (cfg.gups) {
+        if (cfg.latency || cfg.sweep || cfg.loaded || cfg.random_access || cfg.nt_stores || cfg.kernel != "xor")
+            throw std::invalid_argument("--gups cannot be combined with other modes, --kernel, --random or --nt");
+        // Shift the word count down rather than the table size up, which
+        // would wrap for large N.
+        const size_t words = cfg.buffer_size / sizeof(std::uint64_t);
+        if (cfg.gups_log2 != 0 &&
+            (cfg.gups_log2 >= std::numeric_limits<size_t>::digits || (words >> cfg.gups_log2) == 0))
+            throw std::invalid_argument("--gups-log2 table does not fit in --size");
+    }
+    if (cfg.loaded) {
+        if (cfg.latency || cfg.sweep || cfg.random_access)
+            throw std::invalid_argument("--loaded cannot be combined with --latency, --sweep or --random");
+        if (cfg.probe_threads < 1 || cfg.probe_threads > cfg.threads)
+            throw std::invalid_argument("--probe-threads must be between 1 and --threads");
+        if (cfg.buffer_size < 2 * CACHE_LINE)
+            throw std::invalid_argument("--loaded needs a buffer of at least two cache lines");
+    }
+    if (cfg.latency) {
+        if (cfg.random_access || cfg.nt_stores || cfg.kernel != "xor")
+            throw std::invalid_argument("--latency cannot be combined with --kernel, --random or --nt");
+        if (cfg.buffer_size < CACHE_LINE)
+            throw std::invalid_argument("--latency needs a buffer of at least one cache line");
+    }
+    if (cfg.nt_stores) {
+        if (!(kernel.flags & KERNEL_NT))
+            throw std::invalid_argument("the " + cfg.kernel + " kernel does not support --nt");
+        if (cfg.simd == Simd::Scalar || detect_simd() == Simd::Scalar)
+            throw std::invalid_argument("--nt needs a SIMD width (x86-64 with SSE2 or better)");
+    }
+}
+
+} // namespace bst
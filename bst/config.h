@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bst {
+
+struct JsonValue;
+
+// ---------------- Configuration ----------------
+static const int    DEFAULT_THREADS     = 8;                            // default threads
+static const size_t DEFAULT_BUFFER_SIZE = 512ull * 1024ull * 1024ull;   // 512 MB
+static const int    DEFAULT_ITERATIONS  = 10;                           // loops over buffer
+static const std::uint64_t DEFAULT_SEED = 0xC0FFEEu;                    // PRNG seed
+// ------------------------------------------------------------
+
+// SIMD width for the kernels that have explicit vector paths.
+enum class Simd { Auto, Scalar, SSE2, AVX2, AVX512 };
+
+const char* simd_name(Simd s);
+int simd_bits(Simd s);
+
+// Index generator for the random-access kernel.
+enum class Rng { Mt, Xorshift, Splitmix, Wyrand };
+
+const char* rng_name(Rng r);
+
+// Thread placement policy (see plan_affinity()).
+enum class Affinity { None, Compact, Scatter, NoSmt, List };
+
+const char* affinity_name(Affinity a);
+
+// Page placement across NUMA nodes (see place_buffers()).
+enum class Numa { FirstTouch, Local, Remote, Interleave };
+
+const char* numa_name(Numa n);
+
+// Page backing for the buffers (see PageArray).
+enum class Pages { Default, Thp, Huge2M, Huge1G };
+
+const char* pages_name(Pages p);
+
+// How buffer pages are faulted in before any timed run (see place_buffers).
+enum class Prefault { Touch, Populate, Madvise };
+
+const char* prefault_name(Prefault p);
+
+// Result document format (see write_report).
+enum class Format { Text, Json, Csv };
+
+const char* format_name(Format f);
+
+struct Config {
+    std::string   kernel        = "xor";   // name in the KernelRegistry
+    int           threads       = DEFAULT_THREADS;
+    size_t        buffer_size   = DEFAULT_BUFFER_SIZE;
+    int           iterations    = DEFAULT_ITERATIONS;
+    bool          random_access = false;
+    bool          chained       = false;   // legacy serially-dependent checksum
+    std::uint64_t seed          = DEFAULT_SEED;
+    Rng           rng           = Rng::Mt;   // random-access index generator
+    bool          pregen        = false;     // pre-generate random indices
+    Simd          simd          = Simd::Auto;
+    bool          nt_stores     = false;   // non-temporal stores (write, copy)
+    bool          latency       = false;   // pointer-chase latency instead of bandwidth
+    bool          page_aware    = false;   // latency: finish each page before the next
+    bool          sweep         = false;   // working-set sweep
+    size_t        sweep_min     = 4096;    // smallest working set
+    size_t        sweep_max     = 0;       // largest working set (0 = buffer size)
+    int           sweep_ppo     = 2;       // points per octave
+    bool          loaded        = false;   // loaded-latency mode
+    int           probe_threads = 1;       // loaded: threads running the latency probe
+    std::vector<int> inject_delays = {0, 10, 50, 100, 200, 500, 1000, 2000, 5000, 10000};
+    bool          gups          = false;   // HPCC RandomAccess
+    int           gups_log2     = 0;       // table of 2^n words (0 = fill --size)
+    bool          gups_verify   = true;    // serial verification pass
+    Affinity      affinity      = Affinity::None;
+    std::vector<int> cpu_list;             // explicit CPUs for Affinity::List
+    Numa          numa          = Numa::FirstTouch;
+    Pages         pages         = Pages::Default;
+    Prefault      prefault      = Prefault::Touch;
+    bool          scale         = false;   // thread-count scaling sweep
+    bool          scale_pow2    = false;   // scale: powers of two instead of every count
+    double        scale_tolerance = 5.0;   // scale: % of peak that counts as saturated
+    bool          false_sharing = false;   // per-thread counters at fs_distances apart
+    bool          per_thread = false;      // print every thread's bandwidth
+    bool          counters = false;        // per-thread perf_event counters
+    Format        format = Format::Text;   // result document format
+    std::string   output;                  // document file (empty = stdout)
+    std::string   baseline;                // --format json result to compare against
+    double        regression_threshold = 5.0;  // % worse than baseline that fails
+    int           warmup = 0;              // untimed passes before the first trial
+    int           trials = 1;              // measured runs (minimum with target_ci)
+    double        target_ci = 0.0;         // adaptive: stop at this 95% CI half-width, % of mean
+    int           max_trials = 50;         // adaptive: upper bound on trials
+    double        duration = 0.0;          // seconds per run instead of iterations (0 = off)
+    std::vector<size_t> fs_distances = {8, 16, 32, 64, 128, 256};
+};
+
+// ---------------- Option parsing ----------------
+// Value parsers shared by the options; all throw std::invalid_argument
+// naming `key` on malformed input.
+std::uint64_t parse_uint(const std::string& key, const std::string& text, bool allow_hex = false);
+size_t parse_size(const std::string& key, const std::string& text);
+bool parse_bool(const std::string& key, const std::string& text);
+int parse_int(const std::string& key, const std::string& text);
+double parse_double(const std::string& key, const std::string& text);
+double parse_seconds(const std::string& key, const std::string& text);
+std::vector<int> parse_cpu_list(const std::string& key, const std::string& text);
+std::string trim(const std::string& s);
+
+// Applies one option given its long name (without leading dashes).
+void apply_option(Config& cfg, const std::string& key, const std::string& value);
+
+// Config file format: one "key = value" per line, '#' starts a comment.
+void load_config_file(Config& cfg, const std::string& path);
+
+// Applies the "config" object of a saved --format json result.
+void load_baseline_config(Config& cfg, const std::string& path);
+
+// A "config" member of a result document as an option value string.
+std::string json_option_value(const JsonValue& v);
+
+// Throws std::invalid_argument for option combinations that cannot run.
+void validate_config(const Config& cfg);
+
+} // namespace bst
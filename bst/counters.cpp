@@ -0,0 +1,122 @@
+#include "bst/counters.h"
+
+#include <cerrno>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bst {
+
+thread_local CounterSet* thread_counters = nullptr;
+
+#if defined(__linux__)
+static constexpr std::uint64_t hw_cache(std::uint64_t cache, std::uint64_t op, std::uint64_t result) {
+    return cache | (op << 8) | (result << 16);
+}
+
+// Pairs whose ratio matters (instructions / cycles, misses / loads) share a
+// group; a single group of all events would not fit the PMU and never be
+// scheduled. The NODE cache event counts loads that miss the local NUMA
+// node, i.e. remote-node traffic, not all DRAM traffic; not every PMU
+// exposes it. Uncore events are per socket, not per thread, and are left
+// out.
+static const CounterInfo HW_COUNTERS[] = {
+    {CYCLES,       "cycles",        PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, 0},
+    {INSTRUCTIONS, "instructions",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, 0},
+    {LLC_LOADS,    "LLC loads",     PERF_TYPE_HW_CACHE,
+        hw_cache(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_ACCESS), 1},
+    {LLC_MISSES,   "LLC misses",    PERF_TYPE_HW_CACHE,
+        hw_cache(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS), 1},
+    {DTLB_MISSES,  "dTLB misses",   PERF_TYPE_HW_CACHE,
+        hw_cache(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS), 2},
+    {NODE_MISSES,  "node misses",   PERF_TYPE_HW_CACHE,
+        hw_cache(PERF_COUNT_HW_CACHE_NODE, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS), 3},
+};
+
+static const CounterInfo SW_COUNTERS[] = {
+    {TASK_CLOCK,       "task clock",       PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, 0},
+    {SW_PAGE_FAULTS,   "page faults",      PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, 1},
+    {CONTEXT_SWITCHES, "context switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, 2},
+    {CPU_MIGRATIONS,   "CPU migrations",   PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS, 3},
+};
+#endif
+
+bool CounterSet::open() {
+#if defined(__linux__)
+    for (const CounterInfo& c : HW_COUNTERS) add(c);
+    if (!fds_.empty()) {
+        hardware_ = true;
+        return true;
+    }
+    hw_error_ = error_;
+    for (const CounterInfo& c : SW_COUNTERS) add(c);
+    return !fds_.empty();
+#else
+    error_ = "not supported on this platform";
+    return false;
+#endif
+}
+
+void CounterSet::start() {
+#if defined(__linux__)
+    for (const Event& e : fds_) {
+        if (!e.leader) continue;
+        ioctl(e.fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(e.fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+}
+
+CounterValues CounterSet::stop() {
+    CounterValues v;
+#if defined(__linux__)
+    for (const Event& e : fds_)
+        if (e.leader) ioctl(e.fd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    for (const Event& e : fds_) {
+        std::uint64_t buf[3] = {};   // value, time enabled, time running
+        if (read(e.fd, buf, sizeof(buf)) != static_cast<ssize_t>(sizeof(buf)) || buf[2] == 0) continue;
+        v.value[e.id] = static_cast<double>(buf[0]) * static_cast<double>(buf[1]) / static_cast<double>(buf[2]);
+        v.valid |= 1u << e.id;
+    }
+#endif
+    return v;
+}
+
+void CounterSet::add(const CounterInfo& c) {
+#if defined(__linux__)
+    int leader_fd = -1;
+    for (const Event& e : fds_)
+        if (e.group == c.group && e.leader) leader_fd = e.fd;
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = c.type;
+    attr.config = c.config;
+    attr.disabled = leader_fd < 0;   // members follow their leader
+    attr.exclude_kernel = c.type != PERF_TYPE_SOFTWARE;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    const int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader_fd, 0));
+    if (fd < 0) {
+        if (error_.empty()) error_ = std::string(c.name) + ": " + std::strerror(errno);
+        return;
+    }
+    fds_.push_back({fd, c.id, c.group, leader_fd < 0});
+#else
+    (void)c;
+#endif
+}
+
+void CounterSet::close_all() {
+#if defined(__linux__)
+    for (const Event& e : fds_) close(e.fd);
+#endif
+    fds_.clear();
+}
+
+} // namespace bst
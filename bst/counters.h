@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bst {
+
+// ---------------- Performance counters ----------------
+enum Counter {
+    CYCLES, INSTRUCTIONS, LLC_LOADS, LLC_MISSES, DTLB_MISSES, NODE_MISSES,      // hardware
+    TASK_CLOCK, SW_PAGE_FAULTS, CONTEXT_SWITCHES, CPU_MIGRATIONS,              // software
+    COUNTER_COUNT
+};
+
+struct CounterInfo {
+    Counter     id;
+    const char* name;
+    std::uint32_t type;      // perf_event_attr type / config
+    std::uint64_t config;
+    int         group;       // events of one group are scheduled together
+};
+
+// Counter values of one thread or, summed, of a run. `valid` has bit i
+// set when counter i was collected.
+struct CounterValues {
+    double        value[COUNTER_COUNT] = {};
+    std::uint32_t valid = 0;
+
+    bool has(Counter c) const { return (valid >> c) & 1u; }
+    void add(const CounterValues& o) {
+        for (int i = 0; i < COUNTER_COUNT; ++i) value[i] += o.value[i];
+        valid |= o.valid;
+    }
+};
+
+// perf_event counters of the calling thread: the hardware events the PMU
+// grants, or the software events when the PMU is missing or restricted
+// (perf_event_paranoid, containers, VMs without a virtual PMU).
+class CounterSet {
+public:
+    CounterSet() = default;
+    ~CounterSet() { close_all(); }
+    CounterSet(const CounterSet&) = delete;
+    CounterSet& operator=(const CounterSet&) = delete;
+
+    // Opens the counters for the calling thread. Returns false if not even
+    // the software events are available; `error` then says why.
+    bool open();
+    bool hardware() const { return hardware_; }
+    const std::string& error() const { return error_; }
+    const std::string& hardware_error() const { return hw_error_; }
+
+    void start();
+    // Stops counting and returns the values, scaled up when the kernel had
+    // to multiplex the PMU between groups.
+    CounterValues stop();
+
+private:
+    struct Event {
+        int     fd;
+        Counter id;
+        int     group;
+        bool    leader;
+    };
+
+    void add(const CounterInfo& c);
+    void close_all();
+
+    std::vector<Event> fds_;
+    bool hardware_ = false;
+    std::string error_;
+    std::string hw_error_;
+};
+
+// Counters of the calling worker thread, started when it passes a
+// StartGate; null when counters are off.
+extern thread_local CounterSet* thread_counters;
+
+} // namespace bst
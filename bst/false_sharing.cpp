@@ -0,0 +1,61 @@
+#include "bst/benchmarks.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <new>
+
+#include "bst/platform.h"
+
+namespace bst {
+
+// ---------------- False sharing ----------------
+// Every thread increments its own counter, placed `distance` bytes after
+// the previous thread's. Below the cache-line size several counters share
+// a line, and every increment has to pull that line away from the other
+// cores; the throughput collapse against the padded distances is the cost
+// of false sharing.
+static Measurement run_false_sharing_point(const Config& cfg, const Runtime& rt, size_t distance) {
+    const size_t words = (static_cast<size_t>(cfg.threads) * distance) / sizeof(std::uint64_t) + 1;
+    PageArray<std::uint64_t> mem(words);
+    std::vector<std::atomic<std::uint64_t>*> counters(cfg.threads);
+    for (int t = 0; t < cfg.threads; ++t) {
+        void* slot = reinterpret_cast<char*>(mem.data()) + static_cast<size_t>(t) * distance;
+        counters[t] = new (slot) std::atomic<std::uint64_t>(0);
+    }
+    const std::uint64_t increments = FS_INCREMENTS * static_cast<std::uint64_t>(cfg.iterations);
+
+    auto worker = [&](int tid, StartGate& gate, ThreadResult& result) {
+        std::atomic<std::uint64_t>& c = *counters[tid];
+        gate.wait();
+        // A plain counter++ that the compiler must not keep in a register
+        for (std::uint64_t i = 0; i < increments; ++i)
+            c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        result.accesses = increments;
+        result.checksum = c.load(std::memory_order_relaxed);
+    };
+    return run_threads(rt, cfg.threads, worker);
+}
+
+void run_false_sharing(const Config& cfg, const Runtime& rt) {
+    struct Point { size_t distance; double mops; };
+    std::vector<Point> points;
+    for (size_t d : cfg.fs_distances) {
+        const Measurement m = run_false_sharing_point(cfg, rt, d);
+        points.push_back({d, m.seconds > 0 ? static_cast<double>(m.accesses) / m.seconds / 1e6 : 0.0});
+    }
+    double best = 0.0;
+    for (const auto& p : points) best = std::max(best, p.mops);
+
+    std::cout << std::setw(14) << "Distance (B)" << std::setw(18) << "Threads/line"
+              << std::setw(20) << "Increments (M/s)" << std::setw(16) << "vs. best (%)" << "\n";
+    for (const auto& p : points) {
+        const size_t per_line = std::min<size_t>(cfg.threads, std::max<size_t>(1, CACHE_LINE / p.distance));
+        std::cout << std::setw(14) << p.distance << std::setw(18) << per_line
+                  << std::setw(20) << p.mops
+                  << std::setw(16) << (best > 0 ? p.mops / best * 100.0 : 0.0) << "\n";
+    }
+}
+
+} // namespace bst
@@ -0,0 +1,102 @@
+#include "bst/benchmarks.h"
+
+namespace bst {
+
+// ---------------- GUPS (HPCC RandomAccess) ----------------
+// Table[ran & (size - 1)] ^= ran over a 2^n-word table, with ran drawn from
+// the HPCC primitive-polynomial stream. 4 * size updates are split across
+// the threads; each thread runs its share as GUPS_LANES interleaved
+// sub-streams, like the HPCC single-CPU reference, so many independent
+// misses are in flight. Races between threads may lose a few updates; the
+// benchmark allows up to 1% of the table to end up wrong.
+static const std::uint64_t GUPS_POLY   = 0x0000000000000007ull;
+static const std::uint64_t GUPS_PERIOD = 1317624576693539401ull;
+static const int           GUPS_LANES  = 128;
+
+static inline std::uint64_t gups_next(std::uint64_t ran) {
+    return (ran << 1) ^ ((ran >> 63) ? GUPS_POLY : 0);
+}
+
+// n-th element of the stream (HPCC_starts)
+static std::uint64_t gups_starts(std::uint64_t n) {
+    n %= GUPS_PERIOD;
+    if (n == 0) return 0x1;
+
+    std::uint64_t m2[64];
+    std::uint64_t temp = 0x1;
+    for (int i = 0; i < 64; ++i) {
+        m2[i] = temp;
+        temp = gups_next(gups_next(temp));
+    }
+
+    int i = 62;
+    while (i >= 0 && !((n >> i) & 1)) --i;
+
+    std::uint64_t ran = 0x2;
+    while (i > 0) {
+        temp = 0;
+        for (int j = 0; j < 64; ++j)
+            if ((ran >> j) & 1) temp ^= m2[j];
+        ran = temp;
+        i -= 1;
+        if ((n >> i) & 1) ran = gups_next(ran);
+    }
+    return ran;
+}
+
+// Applies updates [first, first + count) of the stream to the table.
+static void gups_updates(std::uint64_t* table, std::uint64_t mask,
+                         std::uint64_t first, std::uint64_t count) {
+    const std::uint64_t per_lane = count / GUPS_LANES;
+    std::uint64_t ran[GUPS_LANES];
+    for (int j = 0; j < GUPS_LANES; ++j)
+        ran[j] = gups_starts(first + static_cast<std::uint64_t>(j) * per_lane);
+    for (std::uint64_t i = 0; i < per_lane; ++i) {
+        for (int j = 0; j < GUPS_LANES; ++j) {
+            ran[j] = gups_next(ran[j]);
+            table[ran[j] & mask] ^= ran[j];
+        }
+    }
+
+    std::uint64_t r = gups_starts(first + GUPS_LANES * per_lane);
+    for (std::uint64_t k = GUPS_LANES * per_lane; k < count; ++k) {
+        r = gups_next(r);
+        table[r & mask] ^= r;
+    }
+}
+
+Measurement run_gups(const Config& cfg, const Runtime& rt, Buffers& bufs, unsigned log2_size) {
+    const std::uint64_t size = 1ull << log2_size;
+    const std::uint64_t updates = 4 * size;
+    std::uint64_t* table = bufs.buf.data();
+    for (std::uint64_t i = 0; i < size; ++i) table[i] = i;
+
+    auto worker = [&](int tid, StartGate& gate, ThreadResult& result) {
+        const std::uint64_t first = updates * static_cast<std::uint64_t>(tid) / cfg.threads;
+        const std::uint64_t last  = updates * static_cast<std::uint64_t>(tid + 1) / cfg.threads;
+        gate.wait();
+        gups_updates(table, size - 1, first, last - first);
+        result.accesses = last - first;
+    };
+    return run_threads(rt, cfg.threads, worker);
+}
+
+// Replays the whole stream serially; XOR undoes every update that was not
+// lost to a race, so any word not back at its initial value is an error.
+std::uint64_t gups_verify(Buffers& bufs, unsigned log2_size) {
+    const std::uint64_t size = 1ull << log2_size;
+    std::uint64_t* table = bufs.buf.data();
+    gups_updates(table, size - 1, 0, 4 * size);
+    std::uint64_t errors = 0;
+    for (std::uint64_t i = 0; i < size; ++i)
+        if (table[i] != i) ++errors;
+    return errors;
+}
+
+unsigned gups_default_log2(size_t bytes) {
+    unsigned n = 0;
+    while ((static_cast<size_t>(2) << n) <= bytes / sizeof(std::uint64_t)) ++n;
+    return n;
+}
+
+} // namespace bst
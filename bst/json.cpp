@@ -0,0 +1,193 @@
+#include "bst/json.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <locale>
+#include <sstream>
+#include <stdexcept>
+
+namespace bst {
+
+// ---------------- JSON reader ----------------
+JsonValue JsonParser::parse() {
+    JsonValue v = value();
+    skip_ws();
+    if (pos_ != s_.size()) fail("trailing characters");
+    return v;
+}
+
+void JsonParser::fail(const std::string& what) const {
+    throw std::invalid_argument("JSON: " + what + " at offset " + std::to_string(pos_));
+}
+
+void JsonParser::skip_ws() {
+    while (pos_ < s_.size() && std::isspace(static_cast<unsigned char>(s_[pos_]))) ++pos_;
+}
+
+bool JsonParser::consume(char c) {
+    skip_ws();
+    if (pos_ < s_.size() && s_[pos_] == c) {
+        ++pos_;
+        return true;
+    }
+    return false;
+}
+
+void JsonParser::expect(char c) {
+    if (!consume(c)) fail(std::string("expected '") + c + "'");
+}
+
+bool JsonParser::literal(const char* word) {
+    const size_t n = std::strlen(word);
+    if (s_.compare(pos_, n, word) != 0) return false;
+    pos_ += n;
+    return true;
+}
+
+JsonValue JsonParser::value() {
+    skip_ws();
+    if (pos_ >= s_.size()) fail("unexpected end");
+    JsonValue v;
+    const char c = s_[pos_];
+    if (c == '{') {
+        ++pos_;
+        v.type = JsonValue::Type::Object;
+        if (consume('}')) return v;
+        do {
+            skip_ws();
+            std::string key = string();
+            expect(':');
+            v.members.emplace_back(std::move(key), value());
+        } while (consume(','));
+        expect('}');
+    } else if (c == '[') {
+        ++pos_;
+        v.type = JsonValue::Type::Array;
+        if (consume(']')) return v;
+        do v.items.push_back(value()); while (consume(','));
+        expect(']');
+    } else if (c == '"') {
+        v.type = JsonValue::Type::String;
+        v.str = string();
+    } else if (literal("true")) {
+        v.type = JsonValue::Type::Bool;
+        v.boolean = true;
+    } else if (literal("false")) {
+        v.type = JsonValue::Type::Bool;
+    } else if (literal("null")) {
+        v.type = JsonValue::Type::Null;
+    } else {
+        const char* begin = s_.c_str() + pos_;
+        char* end = nullptr;
+        v.type = JsonValue::Type::Number;
+        v.number = std::strtod(begin, &end);
+        if (end == begin) fail("unexpected character");
+        pos_ += static_cast<size_t>(end - begin);
+    }
+    return v;
+}
+
+std::string JsonParser::string() {
+    if (pos_ >= s_.size() || s_[pos_] != '"') fail("expected string");
+    ++pos_;
+    std::string out;
+    while (pos_ < s_.size() && s_[pos_] != '"') {
+        char c = s_[pos_++];
+        if (c == '\\') {
+            if (pos_ >= s_.size()) break;
+            c = s_[pos_++];
+            switch (c) {
+            case 'n': out += '\n'; break;
+            case 't': out += '\t'; break;
+            case 'r': out += '\r'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'u':
+                // Only ever written for control characters
+                if (pos_ + 4 > s_.size()) fail("bad escape");
+                out += static_cast<char>(std::stoi(s_.substr(pos_, 4), nullptr, 16));
+                pos_ += 4;
+                break;
+            default: out += c; break;
+            }
+        } else {
+            out += c;
+        }
+    }
+    if (pos_ >= s_.size()) fail("unterminated string");
+    ++pos_;
+    return out;
+}
+
+JsonValue load_json_file(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("cannot open " + path);
+    std::ostringstream text;
+    text << in.rdbuf();
+    try {
+        return JsonParser(text.str()).parse();
+    } catch (const std::invalid_argument& e) {
+        throw std::invalid_argument(path + ": " + e.what());
+    }
+}
+
+// ---------------- JSON writer ----------------
+void JsonWriter::next() {
+    if (first_.empty()) return;
+    if (!first_.back()) os_ << ",";
+    first_.back() = false;
+    os_ << "\n" << std::string(2 * first_.size(), ' ');
+}
+
+void JsonWriter::name(const char* key) {
+    next();
+    if (key) {
+        str(key);
+        os_ << ": ";
+    }
+}
+
+void JsonWriter::open(const char* key, char c) {
+    name(key);
+    os_ << c;
+    first_.push_back(true);
+}
+
+void JsonWriter::close(char c) {
+    const bool empty = first_.back();
+    first_.pop_back();
+    if (!empty) os_ << "\n" << std::string(2 * first_.size(), ' ');
+    os_ << c;
+    if (first_.empty()) os_ << "\n";
+}
+
+void JsonWriter::num(double v) {
+    if (!std::isfinite(v)) {
+        os_ << "null";
+        return;
+    }
+    std::ostringstream tmp;
+    tmp.imbue(std::locale::classic());
+    tmp << std::setprecision(12) << v;
+    os_ << tmp.str();
+}
+
+void JsonWriter::str(const std::string& v) {
+    os_ << '"';
+    for (const char ch : v) {
+        const unsigned char c = static_cast<unsigned char>(ch);
+        if (c == '"' || c == '\\') os_ << '\\' << ch;
+        else if (c == '\n') os_ << "\\n";
+        else if (c == '\t') os_ << "\\t";
+        else if (c < 0x20) os_ << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c)
+                               << std::dec << std::setfill(' ');
+        else os_ << ch;
+    }
+    os_ << '"';
+}
+
+} // namespace bst
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bst {
+
+// ---------------- JSON reader ----------------
+// Just enough JSON to read back our own --format json documents.
+struct JsonValue {
+    enum class Type { Null, Bool, Number, String, Array, Object };
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string str;
+    std::vector<JsonValue> items;                              // Array
+    std::vector<std::pair<std::string, JsonValue>> members;    // Object, in file order
+
+    const JsonValue* get(const std::string& key) const {
+        for (const auto& m : members)
+            if (m.first == key) return &m.second;
+        return nullptr;
+    }
+    double num(const std::string& key, double fallback = 0.0) const {
+        const JsonValue* v = get(key);
+        return v && v->type == Type::Number ? v->number : fallback;
+    }
+};
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : s_(text) {}
+
+    // Parses the whole text; throws std::invalid_argument on malformed input.
+    JsonValue parse();
+
+private:
+    [[noreturn]] void fail(const std::string& what) const;
+    void skip_ws();
+    bool consume(char c);
+    void expect(char c);
+    bool literal(const char* word);
+    JsonValue value();
+    std::string string();
+
+    const std::string& s_;
+    size_t pos_ = 0;
+};
+
+JsonValue load_json_file(const std::string& path);
+
+// ---------------- JSON writer ----------------
+// Minimal streaming JSON writer: two-space indentation, keys in the order
+// written, non-finite numbers as null.
+class JsonWriter {
+public:
+    explicit JsonWriter(std::ostream& os) : os_(os) {}
+
+    void begin_object(const char* key = nullptr) { open(key, '{'); }
+    void end_object() { close('}'); }
+    void begin_array(const char* key = nullptr) { open(key, '['); }
+    void end_array() { close(']'); }
+
+    void field(const char* key, const std::string& v) { name(key); str(v); }
+    void field(const char* key, const char* v) { name(key); str(v); }
+    void field(const char* key, bool v) { name(key); os_ << (v ? "true" : "false"); }
+    void field(const char* key, double v) { name(key); num(v); }
+    void field(const char* key, int v) { name(key); os_ << v; }
+    void field(const char* key, unsigned v) { name(key); os_ << v; }
+    void field(const char* key, long long v) { name(key); os_ << v; }
+    void field(const char* key, std::uint64_t v) { name(key); os_ << v; }
+    void null(const char* key) { name(key); os_ << "null"; }
+    void element(int v) { next(); os_ << v; }
+
+private:
+    void next();
+    void name(const char* key);
+    void open(const char* key, char c);
+    void close(char c);
+    void num(double v);
+    void str(const std::string& v);
+
+    std::ostream& os_;
+    std::vector<bool> first_;
+};
+
+} // namespace bst
@@ -0,0 +1,32 @@
+#include "bst/kernel.h"
+
+#include <stdexcept>
+
+namespace bst {
+
+KernelRegistry& KernelRegistry::instance() {
+    // Function-local so registrars in any translation unit can use it
+    // during static initialisation
+    static KernelRegistry registry;
+    return registry;
+}
+
+void KernelRegistry::add(const KernelInfo& info) {
+    if (find(info.name))
+        throw std::logic_error(std::string("kernel registered twice: ") + info.name);
+    kernels_.push_back(info);
+}
+
+const KernelInfo* KernelRegistry::find(const std::string& name) const {
+    for (const KernelInfo& k : kernels_)
+        if (name == k.name) return &k;
+    return nullptr;
+}
+
+const KernelInfo& kernel_info(const std::string& name) {
+    const KernelInfo* k = KernelRegistry::instance().find(name);
+    if (!k) throw std::invalid_argument("unknown kernel: '" + name + "'");
+    return *k;
+}
+
+} // namespace bst
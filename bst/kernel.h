@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+
+#include "bst/config.h"
+
+namespace bst {
+
+struct Buffers;
+struct SimdKernels;
+
+// ---------------- Kernel interface ----------------
+// A bandwidth kernel is one sequential pass over [begin, end) of the shared
+// buffers: buf for the single-buffer kernels, the STREAM arrays a, b and c
+// for the rest. It folds its checksum contribution (if any) into `sum` and
+// moves `streams` words per word of the range (one in `stride` of them for
+// strided kernels); the runner derives the byte count.
+using KernelPass = void (*)(const Config& cfg, const SimdKernels& vec, Buffers& bufs,
+                            size_t begin, size_t end, std::uint64_t& sum);
+
+// Capabilities a kernel declares; options that need one are rejected for
+// kernels without it.
+enum KernelFlags : unsigned {
+    KERNEL_STREAM  = 1u << 0,   // works on the STREAM arrays a, b, c
+    KERNEL_SIMD    = 1u << 1,   // uses the SimdKernels loops (--simd)
+    KERNEL_NT      = 1u << 2,   // honours --nt
+    KERNEL_RANDOM  = 1u << 3,   // has a random-access variant (--pattern random)
+    KERNEL_CHAINED = 1u << 4,   // has a serially-dependent variant (--chained)
+};
+
+struct KernelInfo {
+    const char* name;
+    int         streams;      // memory streams per element (reads + writes)
+    int         rfo;          // write-only streams that incur a read-for-ownership
+    const char* formula;
+    unsigned    flags;        // KernelFlags
+    KernelPass  pass;
+    int         stride = 1;   // touches one word in `stride`; only those are counted
+    Simd        isa = Simd::Scalar;   // instruction set the pass needs
+};
+
+// Kernels by name. Built-in kernels register themselves from
+// bst/kernels.cpp; code embedding the library adds its own the same way,
+// with a namespace-scope KernelRegistrar.
+class KernelRegistry {
+public:
+    static KernelRegistry& instance();
+
+    // Throws std::logic_error if the name is taken.
+    void add(const KernelInfo& info);
+    // Null if no kernel has that name.
+    const KernelInfo* find(const std::string& name) const;
+    // In registration order; entries never move, so pointers stay valid.
+    const std::deque<KernelInfo>& kernels() const { return kernels_; }
+
+private:
+    std::deque<KernelInfo> kernels_;
+};
+
+struct KernelRegistrar {
+    explicit KernelRegistrar(const KernelInfo& info) { KernelRegistry::instance().add(info); }
+};
+
+// Registered kernel `name`; throws std::invalid_argument if there is none.
+const KernelInfo& kernel_info(const std::string& name);
+
+} // namespace bst
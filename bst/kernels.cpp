@@ -0,0 +1,89 @@
+// Built-in bandwidth kernels. XOR is the original single-buffer
+// read/xor/write loop, READ and WRITE are its one-directional halves; the
+// rest follow STREAM (McCalpin) over three separate double arrays.
+
+#include "bst/buffer.h"
+#include "bst/config.h"
+#include "bst/kernel.h"
+#include "bst/simd.h"
+
+namespace bst {
+
+static const double STREAM_SCALAR = 3.0;
+
+// ---------------- XOR kernel ----------------
+// Original kernel: every iteration depends on the previous sum. Kept for
+// comparison (--chained); it is ALU-latency bound on wide cores.
+static std::uint64_t xor_pass_chained(std::uint64_t* buf, size_t begin, size_t end,
+                                      std::uint64_t sum) {
+    for (size_t i = begin; i < end; ++i) {
+        // Read
+        std::uint64_t v = buf[i];
+        sum += (v ^ (sum << 1));
+        // Write (simple mixing)
+        buf[i] = v ^ XOR_SEQ_MASK;
+    }
+    return sum;
+}
+
+static void xor_kernel(const Config& cfg, const SimdKernels& vec, Buffers& bufs,
+                       size_t begin, size_t end, std::uint64_t& sum) {
+    if (cfg.chained) sum = xor_pass_chained(bufs.buf.data(), begin, end, sum);
+    else             sum += vec.rmw(bufs.buf.data(), begin, end);
+}
+
+static void read_kernel(const Config&, const SimdKernels& vec, Buffers& bufs,
+                        size_t begin, size_t end, std::uint64_t& sum) {
+    sum += vec.read(bufs.buf.data(), begin, end);
+}
+
+static void write_kernel(const Config& cfg, const SimdKernels& vec, Buffers& bufs,
+                         size_t begin, size_t end, std::uint64_t&) {
+    if (cfg.nt_stores) vec.write_nt(bufs.buf.data(), begin, end);
+    else               vec.write(bufs.buf.data(), begin, end);
+}
+
+// ---------------- STREAM kernels ----------------
+// Plain loops the compiler vectorizes; copy also has SIMD and streaming
+// store variants.
+static void copy_kernel(const Config& cfg, const SimdKernels& vec, Buffers& bufs,
+                        size_t begin, size_t end, std::uint64_t&) {
+    if (cfg.nt_stores) vec.copy_nt(bufs.c.data(), bufs.a.data(), begin, end);
+    else               vec.copy(bufs.c.data(), bufs.a.data(), begin, end);
+}
+
+static void scale_kernel(const Config&, const SimdKernels&, Buffers& bufs,
+                         size_t begin, size_t end, std::uint64_t&) {
+    double* b = bufs.b.data();
+    const double* c = bufs.c.data();
+    for (size_t i = begin; i < end; ++i) b[i] = STREAM_SCALAR * c[i];
+}
+
+static void add_kernel(const Config&, const SimdKernels&, Buffers& bufs,
+                       size_t begin, size_t end, std::uint64_t&) {
+    const double* a = bufs.a.data();
+    const double* b = bufs.b.data();
+    double* c = bufs.c.data();
+    for (size_t i = begin; i < end; ++i) c[i] = a[i] + b[i];
+}
+
+static void triad_kernel(const Config&, const SimdKernels&, Buffers& bufs,
+                         size_t begin, size_t end, std::uint64_t&) {
+    double* a = bufs.a.data();
+    const double* b = bufs.b.data();
+    const double* c = bufs.c.data();
+    for (size_t i = begin; i < end; ++i) a[i] = b[i] + STREAM_SCALAR * c[i];
+}
+
+static const KernelRegistrar builtin_kernels[] = {
+    KernelRegistrar({"xor",   2, 0, "buf[i] = buf[i] ^ K",
+                     KERNEL_SIMD | KERNEL_RANDOM | KERNEL_CHAINED, xor_kernel}),
+    KernelRegistrar({"read",  1, 0, "sum += buf[i]",          KERNEL_SIMD, read_kernel}),
+    KernelRegistrar({"write", 1, 1, "buf[i] = K",             KERNEL_SIMD | KERNEL_NT, write_kernel}),
+    KernelRegistrar({"copy",  2, 1, "c[i] = a[i]",            KERNEL_STREAM | KERNEL_SIMD | KERNEL_NT, copy_kernel}),
+    KernelRegistrar({"scale", 2, 1, "b[i] = q * c[i]",        KERNEL_STREAM, scale_kernel}),
+    KernelRegistrar({"add",   3, 1, "c[i] = a[i] + b[i]",     KERNEL_STREAM, add_kernel}),
+    KernelRegistrar({"triad", 3, 1, "a[i] = b[i] + q * c[i]", KERNEL_STREAM, triad_kernel}),
+};
+
+} // namespace bst
@@ -0,0 +1,208 @@
+#include "bst/benchmarks.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+#include "bst/platform.h"
+#include "bst/report.h"
+
+namespace bst {
+
+// ---------------- Pointer chase ----------------
+// Links every cache line of buf into one random cycle: the first word of each
+// line holds the word index of the next line to visit. Visiting lines in a
+// shuffled order and closing the loop yields a single Hamiltonian cycle, so a
+// walk touches every line exactly once per lap and the prefetchers cannot
+// predict the next address. With page_aware set, all lines of a page are
+// visited (in random order) before moving on to the next random page, which
+// keeps the walk from paying a TLB miss on almost every step.
+// Returns one starting word index per thread, evenly spaced along the cycle.
+static std::vector<size_t> build_chase_cycle(std::uint64_t* buf, size_t words, bool page_aware,
+                                             std::uint64_t seed, int threads) {
+    const size_t line_words = CACHE_LINE / sizeof(std::uint64_t);
+    const size_t lines = words / line_words;
+    std::mt19937_64 rng(seed);
+
+    std::vector<size_t> order(lines);
+    for (size_t i = 0; i < lines; ++i) order[i] = i;
+    if (page_aware) {
+        const size_t per_page = BASE_PAGE_BYTES / CACHE_LINE;
+        const size_t pages = (lines + per_page - 1) / per_page;
+        std::vector<size_t> page_order(pages);
+        for (size_t p = 0; p < pages; ++p) page_order[p] = p;
+        std::shuffle(page_order.begin(), page_order.end(), rng);
+        size_t k = 0;
+        for (size_t p : page_order) {
+            const size_t first = p * per_page;
+            const size_t last  = std::min(lines, first + per_page);
+            for (size_t l = first; l < last; ++l) order[k + (l - first)] = l;
+            std::shuffle(order.begin() + static_cast<std::ptrdiff_t>(k),
+                         order.begin() + static_cast<std::ptrdiff_t>(k + (last - first)), rng);
+            k += last - first;
+        }
+    } else {
+        std::shuffle(order.begin(), order.end(), rng);
+    }
+
+    for (size_t k = 0; k < lines; ++k)
+        buf[order[k] * line_words] = order[(k + 1) % lines] * line_words;
+
+    std::vector<size_t> starts(threads);
+    for (int t = 0; t < threads; ++t)
+        starts[t] = order[static_cast<size_t>(t) * lines / threads] * line_words;
+    return starts;
+}
+
+// Dependent load chain: each load's address comes from the previous load.
+static std::uint64_t chase(const std::uint64_t* buf, std::uint64_t p, size_t steps) {
+    size_t n = steps;
+    for (; n >= 4; n -= 4) {
+        p = buf[p];
+        p = buf[p];
+        p = buf[p];
+        p = buf[p];
+    }
+    for (; n > 0; --n) p = buf[p];
+    return p;
+}
+
+// ---------------- Latency ----------------
+Measurement run_latency(const Config& cfg, const Runtime& rt, Buffers& bufs,
+                        size_t words, size_t steps) {
+    std::uint64_t* buf = bufs.buf.data();
+    const std::vector<size_t> starts =
+        build_chase_cycle(buf, words, cfg.page_aware, cfg.seed, cfg.threads);
+
+    auto worker = [&](int tid, StartGate& gate, ThreadResult& result) {
+        std::uint64_t p = starts[tid];
+        gate.wait();
+        p = chase(buf, p, steps);
+        result.accesses = steps;
+        result.checksum = p;
+    };
+    return run_threads(rt, cfg.threads, worker);
+}
+
+// ---------------- Loaded latency ----------------
+// Probe threads chase pointers while the remaining threads generate traffic
+// with rt.kernel, pausing `delay` spin iterations after every chunk; a
+// larger delay injects less bandwidth. Sweeping the delay traces the
+// bandwidth-vs-latency curve (cf. Intel MLC --loaded_latency).
+static const size_t LOADED_CHUNK_WORDS  = 4096;        // 32 KiB between delays
+static const size_t LOADED_PROBE_LOADS  = 1ull << 21;  // dependent loads per probe and point
+
+// Chase region is buf[0, words/2); load threads work on [words/2, words)
+// of the kernel's buffers so probe and load traffic never share lines.
+static Measurement run_loaded_point(const Config& cfg, const Runtime& rt, Buffers& bufs,
+                                    size_t words, const std::vector<size_t>& starts, int delay) {
+    const int probes  = cfg.probe_threads;
+    const int loaders = cfg.threads - probes;
+    const size_t half = words / 2;
+    const size_t load_words = words - half;
+    const size_t per_loader = loaders > 0 ? (load_words + loaders - 1) / loaders : 0;
+    std::atomic<int> probes_left{probes};
+    std::uint64_t* buf = bufs.buf.data();
+
+    auto worker = [&](int tid, StartGate& gate, ThreadResult& result) {
+        if (tid < probes) {
+            std::uint64_t p = starts[tid];
+            gate.wait();
+            p = chase(buf, p, LOADED_PROBE_LOADS);
+            result.accesses = LOADED_PROBE_LOADS;
+            result.checksum = p;
+            probes_left.fetch_sub(1, std::memory_order_release);
+            return;
+        }
+
+        const size_t l = static_cast<size_t>(tid - probes);
+        const size_t begin = std::min(words, half + l * per_loader);
+        const size_t end   = std::min(words, begin + per_loader);
+        gate.wait();
+        if (begin >= end) return;
+
+        std::uint64_t local_sum = 0;
+        std::uint64_t bytes = 0;
+        size_t i = begin;
+        while (probes_left.load(std::memory_order_acquire) > 0) {
+            const size_t stop = std::min(end, i + LOADED_CHUNK_WORDS);
+            bytes += kernel_pass(cfg, rt, bufs, i, stop, local_sum);
+            i = stop == end ? begin : stop;
+            for (int d = 0; d < delay; ++d) cpu_relax();
+        }
+        if (rt.kernel->flags & KERNEL_STREAM) local_sum = stream_checksum(bufs, begin);
+
+        result.bytes_processed = bytes;
+        result.rfo_bytes = rfo_share(cfg, *rt.kernel, bytes);
+        result.checksum = local_sum;
+    };
+    return run_threads(rt, cfg.threads, worker);
+}
+
+void run_loaded(const Config& cfg, const Runtime& rt, Buffers& bufs, size_t words) {
+    const std::vector<size_t> starts =
+        build_chase_cycle(bufs.buf.data(), words / 2, cfg.page_aware, cfg.seed, cfg.probe_threads);
+
+    std::cout << std::setw(14) << "Inject delay" << std::setw(20) << "Bandwidth (MB/s)"
+              << std::setw(16) << "Latency (ns)" << "\n";
+    for (int delay : cfg.inject_delays) {
+        const Measurement m = run_loaded_point(cfg, rt, bufs, words, starts, delay);
+        // ns_per_access() only averages the probes: loaders take no dependent loads
+        std::cout << std::setw(14) << delay
+                  << std::setw(20) << m.mbps()
+                  << std::setw(16) << m.ns_per_access() << std::endl;
+    }
+}
+
+// ---------------- Working-set sweep ----------------
+// Every sweep point moves at least this much data (bandwidth) or takes at
+// least this many loads per thread (latency), so cache-sized points are not
+// dominated by thread start-up.
+static const size_t SWEEP_POINT_BYTES = 256ull * 1024ull * 1024ull;
+static const size_t SWEEP_MIN_LOADS   = 1ull << 20;
+
+// Geometric series from lo to hi with `per_octave` points per doubling,
+// rounded to whole cache lines. hi is always included.
+static std::vector<size_t> sweep_sizes(size_t lo, size_t hi, int per_octave) {
+    std::vector<size_t> sizes;
+    for (int k = 0;; ++k) {
+        const double s = static_cast<double>(lo) * std::pow(2.0, static_cast<double>(k) / per_octave);
+        size_t bytes = static_cast<size_t>(s) / CACHE_LINE * CACHE_LINE;
+        if (bytes >= hi) break;
+        if (sizes.empty() || bytes > sizes.back()) sizes.push_back(bytes);
+    }
+    sizes.push_back(hi / CACHE_LINE * CACHE_LINE);
+    return sizes;
+}
+
+// Runs the bandwidth kernel and the pointer chase at each working-set size,
+// reusing the one allocation made for the largest point.
+void run_sweep(const Config& cfg, const Runtime& rt, Buffers& bufs) {
+    const size_t max_bytes = cfg.sweep_max ? cfg.sweep_max : cfg.buffer_size;
+    const int streams = rt.kernel->streams;
+    const int stride = rt.kernel->stride;
+
+    std::cout << std::setw(12) << "Working set" << std::setw(20) << "Bandwidth (MB/s)"
+              << std::setw(16) << "Latency (ns)" << "\n";
+    for (size_t ws : sweep_sizes(cfg.sweep_min, max_bytes, cfg.sweep_ppo)) {
+        const size_t words = ws / sizeof(std::uint64_t);
+        const size_t moved_per_pass =
+            std::max<size_t>(1, ws * static_cast<size_t>(streams) / static_cast<size_t>(stride));
+        const int passes = static_cast<int>(std::max<size_t>(
+            cfg.iterations, (SWEEP_POINT_BYTES + moved_per_pass - 1) / moved_per_pass));
+        const Measurement bw = run_bandwidth(cfg, rt, bufs, words, passes);
+
+        const size_t lines = ws / CACHE_LINE;
+        const size_t steps = std::max<size_t>(SWEEP_MIN_LOADS, lines / cfg.threads);
+        const Measurement lat = run_latency(cfg, rt, bufs, words, steps);
+
+        std::cout << std::setw(12) << format_size(ws)
+                  << std::setw(20) << bw.mbps()
+                  << std::setw(16) << lat.ns_per_access() << std::endl;
+    }
+}
+
+} // namespace bst
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define BST_X86_64 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define BST_TARGET(isa)
+#else
+#define BST_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace bst {
+
+static const size_t CACHE_LINE = 64;
+static const size_t BASE_PAGE_BYTES = 4096;   // not PAGE_SIZE: <limits.h> defines that on musl and the BSDs
+
+// Distance that keeps two objects from ever sharing a cache line: 128 bytes
+// covers Intel's adjacent-line prefetcher (pairs of 64-byte lines) and the
+// 128-byte lines of Apple cores.
+static const size_t DESTRUCTIVE_INTERFERENCE = 128;
+
+inline void cpu_relax() {
+#if defined(BST_X86_64)
+    _mm_pause();
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+    __asm__ __volatile__("yield");
+#endif
+}
+
+} // namespace bst
@@ -0,0 +1,619 @@
+#include "bst/report.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+#include "bst/json.h"
+#include "bst/stats.h"
+
+namespace bst {
+
+// ---------------- Text report ----------------
+std::string format_size(size_t bytes) {
+    static const char* units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+    double v = static_cast<double>(bytes);
+    int u = 0;
+    while (v >= 1024.0 && u < 4) {
+        v /= 1024.0;
+        ++u;
+    }
+    std::ostringstream os;
+    const bool whole = v >= 100.0 || v == static_cast<double>(static_cast<size_t>(v));
+    os << std::fixed << std::setprecision(whole ? 0 : 1)
+       << v << " " << units[u];
+    return os.str();
+}
+
+void print_trials(const Config& cfg, const std::vector<Measurement>& trials) {
+    std::cout << std::setw(8) << "Trial" << std::setw(16) << "Elapsed (s)" << std::setw(18) << "MB/s" << "\n";
+    for (size_t i = 0; i < trials.size(); ++i) {
+        std::cout << std::setw(8) << i + 1 << std::setprecision(4) << std::setw(16) << trials[i].seconds
+                  << std::setprecision(2) << std::setw(18) << trials[i].mbps() << "\n";
+    }
+    const TrialStats st = trial_stats(trials);
+    std::cout << "\nTrials                : " << trials.size();
+    if (cfg.warmup > 0) std::cout << " (after " << cfg.warmup << " warmup passes)";
+    std::cout << "\n";
+    std::cout << "Throughput (trials)   : min " << st.min << " / median " << st.median << " / mean " << st.mean
+              << " / p90 " << st.p90 << " / max " << st.max << " MB/s\n";
+    std::cout << "Stddev                : " << st.stddev << " MB/s\n";
+    if (trials.size() > 1)
+        std::cout << "95% CI of the mean    : " << st.mean << " +- " << st.ci << " MB/s (+-"
+                  << st.ci_percent() << "%)\n";
+    if (cfg.target_ci > 0 && st.ci_percent() > cfg.target_ci)
+        std::cout << "Warning: CI target of +-" << cfg.target_ci << "% not reached after "
+                  << trials.size() << " trials\n";
+    std::cout << "\n";
+}
+
+void print_page_backing(const Config& cfg, const PageBacking& pb, Pages obtained) {
+    if (!pb.known) return;
+    std::cout << "Page size             : " << format_size(pb.kernel_page);
+    if (obtained == Pages::Huge2M || obtained == Pages::Huge1G)
+        std::cout << " (hugetlb)";
+    else if (pb.rss > 0)
+        std::cout << ", " << static_cast<double>(pb.thp) * 100.0 / static_cast<double>(pb.rss)
+                  << "% in transparent huge pages";
+    if (obtained != cfg.pages)
+        std::cout << " (" << pages_name(cfg.pages) << " unavailable, fell back to " << pages_name(obtained) << ")";
+    std::cout << "\n";
+}
+
+void print_first_touch(const Config& cfg, const Measurement& m) {
+    std::cout << "First touch           : " << format_size(m.bytes) << " in " << m.seconds * 1e3 << " ms, "
+              << m.mbps() << " MB/s (" << prefault_name(cfg.prefault) << ", "
+              << m.threads.size() << " thread(s))\n";
+    if (m.faults == 0) return;
+    std::vector<double> rates;
+    for (const auto& r : m.threads)
+        if (r.seconds > 0 && r.faults > 0) rates.push_back(static_cast<double>(r.faults) / r.seconds);
+    if (rates.empty()) return;
+    std::sort(rates.begin(), rates.end());
+    std::cout << "Page faults           : " << m.faults << ", per thread min " << rates.front()
+              << " / median " << rates[rates.size() / 2] << " / max " << rates.back() << " faults/s\n";
+}
+
+// Counter totals of a run, normalised by `units` (bytes, accesses or
+// updates, named by `unit`): IPC and misses per unit from the hardware
+// counters, or the software counters when that is all there is.
+void print_counters(const Measurement& m, double units, const char* unit) {
+    const CounterValues& c = m.counters;
+    if (!c.valid) return;
+    const double per = units > 0 ? 1.0 / units : 0.0;
+    auto count = [&](Counter id) { return static_cast<std::uint64_t>(c.value[id] + 0.5); };
+    std::cout << std::setprecision(4);
+    if (c.has(CYCLES) && c.has(INSTRUCTIONS) && c.value[CYCLES] > 0)
+        std::cout << "IPC                   : " << c.value[INSTRUCTIONS] / c.value[CYCLES] << " ("
+                  << count(INSTRUCTIONS) << " instructions / " << count(CYCLES) << " cycles)\n";
+    if (c.has(LLC_MISSES)) {
+        std::cout << "LLC misses / " << std::left << std::setw(9) << unit << std::right << ": "
+                  << c.value[LLC_MISSES] * per;
+        if (c.has(LLC_LOADS) && c.value[LLC_LOADS] > 0)
+            std::cout << " (" << std::setprecision(2) << c.value[LLC_MISSES] * 100.0 / c.value[LLC_LOADS]
+                      << "% of " << count(LLC_LOADS) << " LLC loads)" << std::setprecision(4);
+        std::cout << "\n";
+    }
+    if (c.has(DTLB_MISSES))
+        std::cout << "dTLB misses / " << std::left << std::setw(8) << unit << std::right << ": "
+                  << c.value[DTLB_MISSES] * per << "\n";
+    if (c.has(NODE_MISSES))
+        std::cout << "Node misses / " << std::left << std::setw(8) << unit << std::right << ": "
+                  << c.value[NODE_MISSES] * per << "\n";
+    std::cout << std::setprecision(2);
+    if (c.has(TASK_CLOCK))
+        std::cout << "Task clock            : " << c.value[TASK_CLOCK] / 1e6 << " ms ("
+                  << (m.seconds > 0 ? c.value[TASK_CLOCK] / 1e9 / m.seconds : 0.0) << " CPUs utilised)\n";
+    if (c.has(CONTEXT_SWITCHES))
+        std::cout << "Context switches      : " << count(CONTEXT_SWITCHES) << "\n";
+    if (c.has(CPU_MIGRATIONS))
+        std::cout << "CPU migrations        : " << count(CPU_MIGRATIONS) << "\n";
+    if (c.has(SW_PAGE_FAULTS))
+        std::cout << "Page faults (timed)   : " << count(SW_PAGE_FAULTS) << "\n";
+}
+
+// Threads more than this far below the median per-thread bandwidth are
+// reported as stragglers.
+static const double STRAGGLER_THRESHOLD = 10.0; // percent
+
+// Spread of the per-thread bandwidths of a run: min / median / max /
+// stddev, the concurrent bandwidth next to the wall-time one, stragglers,
+// and with --per-thread a line per thread.
+void print_thread_balance(const Config& cfg, const Runtime& rt, const Measurement& m) {
+    std::vector<int> active;
+    for (int t = 0; t < static_cast<int>(m.threads.size()); ++t)
+        if (m.threads[t].bytes_processed > 0) active.push_back(t);
+    if (active.empty()) return;
+
+    std::vector<double> rates;
+    double mean = 0.0;
+    for (int t : active) {
+        rates.push_back(m.threads[t].mbps());
+        mean += rates.back();
+    }
+    mean /= static_cast<double>(rates.size());
+    double var = 0.0;
+    for (double r : rates) var += (r - mean) * (r - mean);
+    const double stddev = std::sqrt(var / static_cast<double>(rates.size()));
+    std::vector<double> sorted = rates;
+    std::sort(sorted.begin(), sorted.end());
+    const size_t n = sorted.size();
+    const double median = n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2.0;
+
+    if (m.window > 0)
+        std::cout << "Concurrent throughput : " << m.concurrent_mbps() << " MB/s (while all threads ran)\n";
+    else
+        std::cout << "Concurrent throughput : n/a (the threads never all ran at once)\n";
+    std::cout << "Per-thread throughput : min " << sorted.front() << " / median " << median
+              << " / max " << sorted.back() << " / stddev " << stddev << " MB/s\n";
+
+    std::ostringstream stragglers;
+    stragglers << std::fixed << std::setprecision(1);
+    for (size_t i = 0; i < active.size(); ++i) {
+        if (median <= 0 || rates[i] >= median * (1.0 - STRAGGLER_THRESHOLD / 100.0)) continue;
+        if (stragglers.tellp() > 0) stragglers << ", ";
+        stragglers << "thread " << active[i] << " (" << (1.0 - rates[i] / median) * 100.0 << "% below median)";
+    }
+    if (stragglers.tellp() > 0)
+        std::cout << "Stragglers            : " << stragglers.str() << "\n";
+
+    if (!cfg.per_thread) return;
+    std::cout << "\n" << std::setw(8) << "Thread" << std::setw(8) << "CPU"
+              << std::setw(20) << "Bytes" << std::setw(14) << "Time (s)" << std::setw(18) << "MB/s" << "\n";
+    for (int t : active) {
+        const ThreadResult& r = m.threads[t];
+        std::cout << std::setw(8) << t << std::setw(8) << (rt.cpus.empty() ? std::string("-") : std::to_string(rt.cpus[t]))
+                  << std::setw(20) << r.bytes_processed << std::setw(14) << std::setprecision(4) << r.seconds
+                  << std::setprecision(2) << std::setw(18) << r.mbps() << "\n";
+    }
+}
+
+// Start skew and the all-threads-active window, printed after the elapsed
+// time of a run.
+void print_start_timing(const Measurement& m) {
+    std::cout << "Start skew            : " << m.start_skew * 1e6 << " us\n";
+    std::cout << "Concurrent window     : " << m.window * 1e3 << " ms\n";
+}
+
+// ---------------- Machine-readable output ----------------
+// Version of the JSON/CSV layout below. Fields may be added within a
+// version; renaming or removing one bumps it.
+static const char* const REPORT_SCHEMA = "memory-stress-test/1";
+
+static const char* counter_key(Counter c) {
+    switch (c) {
+    case CYCLES:           return "cycles";
+    case INSTRUCTIONS:     return "instructions";
+    case LLC_LOADS:        return "llc_loads";
+    case LLC_MISSES:       return "llc_misses";
+    case DTLB_MISSES:      return "dtlb_misses";
+    case NODE_MISSES:      return "node_misses";
+    case TASK_CLOCK:       return "task_clock_ns";
+    case SW_PAGE_FAULTS:   return "page_faults";
+    case CONTEXT_SWITCHES: return "context_switches";
+    case CPU_MIGRATIONS:   return "cpu_migrations";
+    case COUNTER_COUNT:    break;
+    }
+    return "?";
+}
+
+static std::string hex64(std::uint64_t v) {
+    std::ostringstream os;
+    os << "0x" << std::hex << v;
+    return os.str();
+}
+
+static std::string host_name() {
+#if defined(__linux__)
+    char buf[256] = {};
+    if (gethostname(buf, sizeof(buf) - 1) == 0) return buf;
+#endif
+    return "";
+}
+
+static std::string access_pattern(const Config& cfg) {
+    if (cfg.latency) return "chase";
+    if (cfg.gups) return "";
+    return cfg.random_access ? "random" : "seq";
+}
+
+// The options that define a run, keyed by their long option names.
+static void write_config_json(JsonWriter& w, const Config& cfg) {
+    w.begin_object("config");
+    w.field("kernel", cfg.kernel);
+    w.field("threads", cfg.threads);
+    w.field("size", static_cast<std::uint64_t>(cfg.buffer_size));
+    w.field("iterations", cfg.iterations);
+    w.field("duration", cfg.duration);
+    if (cfg.latency || cfg.gups) w.null("pattern");
+    else                         w.field("pattern", cfg.random_access ? "random" : "seq");
+    w.field("latency", cfg.latency);
+    w.field("gups", cfg.gups);
+    w.field("rng", rng_name(cfg.rng));
+    w.field("seed", hex64(cfg.seed));     // a double would round seeds above 2^53
+    w.field("pregen", cfg.pregen);
+    w.field("simd", simd_name(cfg.simd));
+    w.field("nt", cfg.nt_stores);
+    w.field("chained", cfg.chained);
+    w.field("page-aware", cfg.page_aware);
+    w.field("gups-log2", cfg.gups_log2);
+    w.field("gups-verify", cfg.gups_verify);
+    w.field("affinity", affinity_name(cfg.affinity));
+    w.begin_array("cpus");
+    for (int c : cfg.cpu_list) w.element(c);
+    w.end_array();
+    w.field("numa", numa_name(cfg.numa));
+    w.field("pages", pages_name(cfg.pages));
+    w.field("prefault", prefault_name(cfg.prefault));
+    w.field("warmup", cfg.warmup);
+    w.field("trials", cfg.trials);
+    w.field("target-ci", cfg.target_ci);
+    w.field("max-trials", cfg.max_trials);
+    w.field("counters", cfg.counters);
+    w.end_object();
+}
+
+static void write_host_json(JsonWriter& w, const Runtime& rt, const NumaTopology& numa) {
+    w.begin_object("host");
+    w.field("hostname", host_name());
+    w.field("logical_cpus", std::thread::hardware_concurrency());
+    w.field("simd_detected", simd_name(detect_simd()));
+    w.field("numa_nodes", static_cast<int>(numa.nodes.size()));
+    w.begin_array("topology");
+    for (const CpuInfo& c : read_topology()) {
+        w.begin_object();
+        w.field("cpu", c.cpu);
+        w.field("package", c.package);
+        w.field("core", c.core);
+        w.field("smt", c.smt);
+        w.field("node", numa.node_of(c.cpu));
+        w.end_object();
+    }
+    w.end_array();
+    w.begin_array("thread_cpus");
+    for (int c : rt.cpus) w.element(c);
+    w.end_array();
+    w.end_object();
+}
+
+// Bandwidth runs count bytes, latency and GUPS runs count accesses; the
+// metrics a mode does not measure are written as null, not as zeros.
+static void write_measurement_json(JsonWriter& w, const Measurement& m, const Runtime& rt, bool bandwidth) {
+    auto measured = [&](const char* key, bool has, auto v) {
+        if (has) w.field(key, v);
+        else     w.null(key);
+    };
+    w.field("seconds", m.seconds);
+    measured("bytes", bandwidth, m.bytes);
+    measured("rfo_bytes", bandwidth, m.rfo_bytes);
+    measured("accesses", !bandwidth, m.accesses);
+    measured("mbps", bandwidth, m.mbps());
+    measured("rfo_mbps", bandwidth, m.rfo_mbps());
+    measured("concurrent_mbps", bandwidth, m.concurrent_mbps());
+    w.field("start_skew_seconds", m.start_skew);
+    w.field("window_seconds", m.window);
+    w.field("checksum", hex64(m.checksum));
+    w.begin_object("counters");
+    for (int c = 0; c < COUNTER_COUNT; ++c)
+        if (m.counters.has(static_cast<Counter>(c))) w.field(counter_key(static_cast<Counter>(c)), m.counters.value[c]);
+    w.end_object();
+    w.begin_array("threads");
+    for (size_t t = 0; t < m.threads.size(); ++t) {
+        const ThreadResult& r = m.threads[t];
+        w.begin_object();
+        w.field("thread", static_cast<int>(t));
+        w.field("cpu", t < rt.cpus.size() ? rt.cpus[t] : -1);
+        w.field("seconds", r.seconds);
+        measured("bytes", bandwidth, r.bytes_processed);
+        measured("accesses", !bandwidth, r.accesses);
+        measured("mbps", bandwidth, r.mbps());
+        w.field("faults", r.faults);
+        w.end_object();
+    }
+    w.end_array();
+}
+
+static void write_json(std::ostream& os, const Config& cfg, const Runtime& rt,
+                       const NumaTopology& numa, const RunRecord& rec) {
+    const bool bandwidth = rec.mode == "bandwidth";
+    JsonWriter w(os);
+    w.begin_object();
+    w.field("schema", REPORT_SCHEMA);
+    w.field("mode", rec.mode);
+    write_config_json(w, cfg);
+    write_host_json(w, rt, numa);
+
+    w.begin_object("memory");
+    w.field("pages", pages_name(rec.pages_obtained));
+    w.field("page_size", static_cast<std::uint64_t>(rec.backing.kernel_page));
+    w.field("thp_bytes", static_cast<std::uint64_t>(rec.backing.thp));
+    w.begin_object("first_touch");
+    w.field("seconds", rec.first_touch.seconds);
+    w.field("bytes", rec.first_touch.bytes);
+    w.field("mbps", rec.first_touch.mbps());
+    w.field("faults", rec.first_touch.faults);
+    w.end_object();
+    w.end_object();
+
+    w.begin_array("trials");
+    for (size_t i = 0; i < rec.trials.size(); ++i) {
+        w.begin_object();
+        w.field("trial", static_cast<int>(i + 1));
+        write_measurement_json(w, rec.trials[i], rt, bandwidth);
+        w.end_object();
+    }
+    w.end_array();
+
+    // Headline numbers, from the reported trial and across trials
+    const Measurement& m = rec.trials[rec.reported];
+    w.begin_object("summary");
+    w.field("trials", static_cast<int>(rec.trials.size()));
+    if (rec.simd_used) w.field("simd", simd_name(rec.simd));
+    else               w.null("simd");
+    w.field("seconds", m.seconds);
+    if (bandwidth) {
+        w.field("bytes", m.bytes);
+        w.field("mbps", m.mbps());
+        w.field("rfo_mbps", m.rfo_mbps());
+        w.field("concurrent_mbps", m.concurrent_mbps());
+        const TrialStats st = trial_stats(rec.trials);
+        w.field("mbps_min", st.min);
+        w.field("mbps_median", st.median);
+        w.field("mbps_mean", st.mean);
+        w.field("mbps_p90", st.p90);
+        w.field("mbps_max", st.max);
+        w.field("mbps_stddev", st.stddev);
+        w.field("mbps_ci95", st.ci);
+    } else {
+        for (const char* key : {"bytes", "mbps", "rfo_mbps", "concurrent_mbps"}) w.null(key);
+    }
+    if (rec.mode == "latency") {
+        w.field("latency_ns", rec.latency_ns);
+    } else if (rec.mode == "gups") {
+        w.field("gups", rec.gups);
+        w.field("gups_log2", rec.gups_log2);
+        w.field("gups_errors", rec.gups_errors);
+    }
+    if (m.counters.has(CYCLES) && m.counters.has(INSTRUCTIONS) && m.counters.value[CYCLES] > 0)
+        w.field("ipc", m.counters.value[INSTRUCTIONS] / m.counters.value[CYCLES]);
+    if (m.counters.has(LLC_MISSES) && m.bytes > 0)
+        w.field("llc_misses_per_byte", m.counters.value[LLC_MISSES] / static_cast<double>(m.bytes));
+    if (m.counters.has(DTLB_MISSES) && m.bytes > 0)
+        w.field("dtlb_misses_per_byte", m.counters.value[DTLB_MISSES] / static_cast<double>(m.bytes));
+    w.end_object();
+
+    if (!cfg.baseline.empty()) {
+        w.begin_object("baseline");
+        w.field("file", cfg.baseline);
+        w.field("threshold_percent", cfg.regression_threshold);
+        w.begin_array("metrics");
+        for (const Comparison& c : rec.comparison) {
+            w.begin_object();
+            w.field("metric", c.metric);
+            w.field("baseline", c.base_mean);
+            w.field("current", c.cur_mean);
+            w.field("delta_percent", c.delta);
+            w.field("t", c.tested ? c.t : std::numeric_limits<double>::quiet_NaN());
+            w.field("significant", c.significant);
+            w.field("gating", c.gates);
+            w.field("regression", c.regression);
+            w.end_object();
+        }
+        w.end_array();
+        w.end_object();
+    }
+    w.end_object();
+}
+
+// One row per trial and per thread of every trial, each carrying the
+// run's defining options, so files from many runs can be concatenated.
+static void write_csv(std::ostream& os, const Config& cfg, const Runtime& rt, const RunRecord& rec) {
+    os << "schema,mode,kernel,pattern,threads,size,iterations,duration,simd,affinity,numa,pages,"
+          "record,trial,thread,cpu,seconds,bytes,accesses,mbps,faults\n";
+    std::ostringstream prefix;
+    prefix.imbue(std::locale::classic());
+    prefix << REPORT_SCHEMA << ',' << rec.mode << ','
+           << (cfg.latency ? "chase" : cfg.gups ? "gups" : cfg.kernel) << ','
+           << access_pattern(cfg) << ',' << cfg.threads << ',' << cfg.buffer_size << ','
+           << cfg.iterations << ',' << cfg.duration << ','
+           << (rec.simd_used ? simd_name(rec.simd) : "") << ',' << affinity_name(cfg.affinity) << ','
+           << numa_name(cfg.numa) << ',' << pages_name(rec.pages_obtained) << ',';
+    const std::ios_base::fmtflags flags = os.flags();
+    const std::streamsize precision = os.precision();
+    os << std::defaultfloat << std::setprecision(12);
+    // Fields the mode does not measure are left empty
+    const bool bandwidth = rec.mode == "bandwidth";
+    auto measured = [&](bool has, auto v) {
+        if (has) os << v;
+        os << ',';
+    };
+    for (size_t i = 0; i < rec.trials.size(); ++i) {
+        const Measurement& m = rec.trials[i];
+        os << prefix.str() << "trial," << i + 1 << ",,," << m.seconds << ',';
+        measured(bandwidth, m.bytes);
+        measured(!bandwidth, m.accesses);
+        measured(bandwidth, m.mbps());
+        os << m.faults << '\n';
+        for (size_t t = 0; t < m.threads.size(); ++t) {
+            const ThreadResult& r = m.threads[t];
+            os << prefix.str() << "thread," << i + 1 << ',' << t << ','
+               << (t < rt.cpus.size() ? std::to_string(rt.cpus[t]) : std::string()) << ','
+               << r.seconds << ',';
+            measured(bandwidth, r.bytes_processed);
+            measured(!bandwidth, r.accesses);
+            measured(bandwidth, r.mbps());
+            os << r.faults << '\n';
+        }
+    }
+    os.flags(flags);
+    os.precision(precision);
+}
+
+bool write_report(std::ostream& os, const Config& cfg, const Runtime& rt,
+                  const NumaTopology& numa, const RunRecord& rec) {
+    if (cfg.format == Format::Text) return true;
+    if (cfg.format == Format::Json) write_json(os, cfg, rt, numa, rec);
+    else                            write_csv(os, cfg, rt, rec);
+    os.flush();
+    if (!os) {
+        std::cerr << "Error: writing the " << format_name(cfg.format) << " report failed\n";
+        return false;
+    }
+    return true;
+}
+
+// ---------------- Baseline comparison ----------------
+// Welch's two-sample t-test: significance needs at least two samples on
+// each side. A change counts as a regression when it is worse than the
+// threshold and either significant or, without enough samples to test,
+// simply beyond the threshold.
+static void evaluate(Comparison& c, double threshold) {
+    c.base_mean = sample_mean(c.base);
+    c.cur_mean = sample_mean(c.cur);
+    c.delta = c.base_mean != 0.0 ? (c.cur_mean - c.base_mean) / c.base_mean * 100.0 : 0.0;
+    if (c.base.size() >= 2 && c.cur.size() >= 2) {
+        const double nb = static_cast<double>(c.base.size()), nc = static_cast<double>(c.cur.size());
+        const double vb = sample_variance(c.base, c.base_mean) / nb;
+        const double vc = sample_variance(c.cur, c.cur_mean) / nc;
+        c.tested = true;
+        if (vb + vc > 0.0) {
+            c.t = (c.cur_mean - c.base_mean) / std::sqrt(vb + vc);
+            const double df = (vb + vc) * (vb + vc) /
+                              ((vb > 0 ? vb * vb / (nb - 1) : 0.0) + (vc > 0 ? vc * vc / (nc - 1) : 0.0));
+            c.significant = std::fabs(c.t) > student_t95(static_cast<int>(df));
+        } else {
+            c.significant = c.cur_mean != c.base_mean;
+        }
+    }
+    const double worse = c.higher_is_better ? -c.delta : c.delta;
+    c.regression = c.gates && worse > threshold && (c.significant || !c.tested);
+}
+
+// Per-trial values of `key` from a result document's "trials" array;
+// trials where it is null (not measured) are left out.
+static std::vector<double> trial_values(const JsonValue& doc, const char* key) {
+    std::vector<double> v;
+    if (const JsonValue* trials = doc.get("trials"))
+        for (const JsonValue& t : trials->items)
+            if (const JsonValue* x = t.get(key))
+                if (x->type == JsonValue::Type::Number) v.push_back(x->number);
+    return v;
+}
+
+// Per-thread load-to-use latencies (ns) of a latency run.
+static std::vector<double> thread_latencies(const std::vector<ThreadResult>& threads) {
+    std::vector<double> v;
+    for (const ThreadResult& r : threads)
+        if (r.accesses > 0) v.push_back(r.seconds * 1e9 / static_cast<double>(r.accesses));
+    return v;
+}
+
+static std::vector<Comparison> compare_with_baseline(const Config& cfg, const JsonValue& doc, const RunRecord& rec) {
+    std::vector<Comparison> out;
+    auto add = [&](const char* metric, bool higher, bool gates, std::vector<double> base, std::vector<double> cur) {
+        if (base.empty() || cur.empty()) return;
+        Comparison c;
+        c.metric = metric;
+        c.higher_is_better = higher;
+        c.gates = gates;
+        c.base = std::move(base);
+        c.cur = std::move(cur);
+        evaluate(c, cfg.regression_threshold);
+        out.push_back(std::move(c));
+    };
+    auto per_trial = [&](double (Measurement::*metric)() const) {
+        std::vector<double> v;
+        for (const Measurement& m : rec.trials)
+            if (std::isfinite((m.*metric)())) v.push_back((m.*metric)());
+        return v;
+    };
+
+    if (rec.mode == "bandwidth") {
+        add("mbps", true, true, trial_values(doc, "mbps"), per_trial(&Measurement::mbps));
+        add("concurrent_mbps", true, false, trial_values(doc, "concurrent_mbps"),
+            per_trial(&Measurement::concurrent_mbps));
+    } else if (rec.mode == "latency") {
+        std::vector<ThreadResult> base_threads;
+        if (const JsonValue* trials = doc.get("trials"))
+            for (const JsonValue& t : trials->items)
+                if (const JsonValue* threads = t.get("threads"))
+                    for (const JsonValue& th : threads->items) {
+                        ThreadResult r;
+                        r.seconds = th.num("seconds");
+                        r.accesses = static_cast<std::uint64_t>(th.num("accesses"));
+                        base_threads.push_back(r);
+                    }
+        add("latency_ns", false, true, thread_latencies(base_threads), thread_latencies(rec.trials[rec.reported].threads));
+    } else if (rec.mode == "gups") {
+        if (const JsonValue* summary = doc.get("summary"))
+            add("gups", true, true, {summary->num("gups")}, {rec.gups});
+    }
+    if (const JsonValue* memory = doc.get("memory"))
+        if (const JsonValue* ft = memory->get("first_touch"))
+            add("first_touch_mbps", true, false, {ft->num("mbps")}, {rec.first_touch.mbps()});
+    return out;
+}
+
+bool report_baseline(const Config& cfg, RunRecord& rec) {
+    const JsonValue doc = load_json_file(cfg.baseline);
+    const JsonValue* mode = doc.get("mode");
+    if (!mode || mode->str != rec.mode)
+        throw std::invalid_argument(cfg.baseline + ": baseline is a " + (mode ? mode->str : std::string("?")) +
+                                    " run, this is a " + rec.mode + " run");
+    rec.comparison = compare_with_baseline(cfg, doc, rec);
+
+    // Options given after --baseline may have changed what is measured
+    std::ostringstream current;
+    JsonWriter w(current);
+    w.begin_object();
+    write_config_json(w, cfg);
+    w.end_object();
+    const JsonValue now = JsonParser(current.str()).parse();
+    const JsonValue* then = doc.get("config");
+    for (const auto& m : now.get("config")->members) {
+        if (m.first == "trials" || m.first == "warmup" || m.first == "target-ci" ||
+            m.first == "max-trials" || m.first == "counters")
+            continue;
+        const JsonValue* old = then ? then->get(m.first) : nullptr;
+        const std::string was = old ? json_option_value(*old) : "";
+        const std::string is = json_option_value(m.second);
+        if (was != is)
+            std::cerr << "Warning: " << m.first << " differs from the baseline ("
+                      << (was.empty() ? "unset" : was) << " -> " << (is.empty() ? "unset" : is) << ")\n";
+    }
+
+    std::string host;
+    if (const JsonValue* h = doc.get("host"))
+        if (const JsonValue* name = h->get("hostname")) host = name->str;
+    std::cout << "\nBaseline              : " << cfg.baseline << (host.empty() ? "" : " (" + host + ")") << "\n";
+    std::cout << std::left << std::setw(20) << "Metric" << std::right << std::setw(16) << "Baseline"
+              << std::setw(16) << "Current" << std::setw(12) << "Delta" << "  Significance\n";
+    bool regressed = false;
+    for (const Comparison& c : rec.comparison) {
+        std::cout << std::left << std::setw(20) << c.metric << std::right
+                  << std::setw(16) << c.base_mean << std::setw(16) << c.cur_mean
+                  << std::setw(11) << std::showpos << c.delta << std::noshowpos << "%  ";
+        if (c.tested)
+            std::cout << (c.significant ? "significant" : "not significant") << " (t = " << c.t << ")";
+        else
+            std::cout << "untested (one sample; use --trials)";
+        if (c.regression) std::cout << "  REGRESSION";
+        std::cout << "\n";
+        regressed = regressed || c.regression;
+    }
+    std::cout << "Result                : " << (regressed ? "REGRESSION" : "OK") << " (threshold "
+              << cfg.regression_threshold << "% on gating metrics)\n";
+    return !regressed;
+}
+
+} // namespace bst
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "bst/buffer.h"
+#include "bst/config.h"
+#include "bst/runner.h"
+#include "bst/topology.h"
+
+namespace bst {
+
+// ---------------- Text report ----------------
+// Human-readable size: "512 MiB", "1.5 KiB".
+std::string format_size(size_t bytes);
+
+// Per-trial table and the statistics across trials.
+void print_trials(const Config& cfg, const std::vector<Measurement>& trials);
+
+// Page size the buffers actually got (`obtained`), once they have been
+// touched.
+void print_page_backing(const Config& cfg, const PageBacking& pb, Pages obtained);
+
+// Cost of faulting the buffers in: bandwidth of the first-touch phase and
+// the page-fault rate each thread sustained during it.
+void print_first_touch(const Config& cfg, const Measurement& m);
+
+// Counter totals of a run, normalised by `units` (bytes, accesses or
+// updates, named by `unit`).
+void print_counters(const Measurement& m, double units, const char* unit);
+
+// Spread of the per-thread bandwidths of a run and, with --per-thread, a
+// line per thread.
+void print_thread_balance(const Config& cfg, const Runtime& rt, const Measurement& m);
+
+// Start skew and the all-threads-active window, printed after the elapsed
+// time of a run.
+void print_start_timing(const Measurement& m);
+
+// ---------------- Machine-readable output ----------------
+// One metric of the current run against the same metric of the baseline,
+// each given as a sample (per trial, or per thread for latency).
+struct Comparison {
+    std::string metric;
+    bool higher_is_better = true;
+    bool gates = false;              // can fail the run
+    std::vector<double> base, cur;
+
+    double base_mean = 0.0, cur_mean = 0.0;
+    double delta = 0.0;              // % change, current vs baseline
+    double t = 0.0;                  // Welch's t statistic
+    bool   tested = false;           // both samples large enough for the test
+    bool   significant = false;      // |t| above the two-sided 95% critical value
+    bool   regression = false;
+};
+
+// Everything a run produced, collected for write_report().
+struct RunRecord {
+    std::string mode;                  // "bandwidth", "latency" or "gups"
+    std::vector<Measurement> trials;   // one unless --trials / --target-ci
+    size_t reported = 0;               // trial shown in the text report
+    Measurement first_touch;
+    PageBacking backing;
+    Pages pages_obtained = Pages::Default;
+    bool simd_used = false;
+    Simd simd = Simd::Scalar;
+    double latency_ns = 0.0;           // latency mode
+    double gups = 0.0;                 // GUPS mode
+    unsigned gups_log2 = 0;
+    long long gups_errors = -1;        // -1 = not verified
+    std::vector<Comparison> comparison;  // with --baseline
+};
+
+// Writes the --format document to `os` (the --output file, or the real
+// stdout with the text report silenced). Returns false on I/O errors.
+bool write_report(std::ostream& os, const Config& cfg, const Runtime& rt,
+                  const NumaTopology& numa, const RunRecord& rec);
+
+// ---------------- Baseline comparison ----------------
+// Loads the --baseline document, compares and prints the table. Returns
+// false when a gating metric regressed.
+bool report_baseline(const Config& cfg, RunRecord& rec);
+
+} // namespace bst
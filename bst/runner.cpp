@@ -0,0 +1,114 @@
+#include "bst/runner.h"
+
+#include <algorithm>
+
+#include "bst/topology.h"
+
+namespace bst {
+
+void ProgressLog::thin() {
+    for (size_t i = 0; 2 * i + 1 < samples_.size(); ++i) samples_[i] = samples_[2 * i + 1];
+    samples_.resize(samples_.size() / 2);
+    spacing_ *= 2;
+}
+
+// Bytes r had moved by `t`, interpolated between its progress samples and
+// its start and finish.
+static double bytes_at(const ThreadResult& r, Clock::time_point t) {
+    ProgressLog::Sample prev{r.started, 0};
+    auto interpolate = [&](const ProgressLog::Sample& next) {
+        const double span = std::chrono::duration<double>(next.time - prev.time).count();
+        const double into = std::chrono::duration<double>(t - prev.time).count();
+        const double moved = static_cast<double>(next.bytes - prev.bytes);
+        return static_cast<double>(prev.bytes) + (span > 0 ? moved * std::min(1.0, std::max(0.0, into / span)) : moved);
+    };
+    for (const ProgressLog::Sample& s : r.progress.samples()) {
+        if (t <= s.time) return interpolate(s);
+        prev = s;
+    }
+    return interpolate({r.finished, r.bytes_processed});
+}
+
+void WorkerPool::loop(int t, int cpu) {
+    if (cpu >= 0) pin_current_thread(cpu);
+    CounterSet counters;
+    if (counters_ && counters.open()) thread_counters = &counters;
+    std::uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lk(m_);
+            cv_.wait(lk, [&]{ return stop_ || generation_ != seen; });
+            if (stop_) return;
+            seen = generation_;
+        }
+        ThreadResult& r = (*results_)[t];
+        (*job_)(t, *gate_, r);
+        r.finished = Clock::now();
+        if (thread_counters) r.counters = thread_counters->stop();
+        r.started = gate_passed_at;
+        r.seconds = std::chrono::duration<double>(r.finished - r.started).count();
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            if (++done_ == num_threads_) done_cv_.notify_one();
+        }
+    }
+}
+
+Measurement WorkerPool::run(const Job& job) {
+    StartGate gate;
+    gate.spin = num_threads_ < static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<ThreadResult> results(num_threads_);
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        job_ = &job;
+        gate_ = &gate;
+        results_ = &results;
+        done_ = 0;
+        ++generation_;
+    }
+    cv_.notify_all();
+
+    // Start timer and release gate once every worker is waiting
+    gate.wait_for_arrivals(num_threads_);
+    auto t0 = Clock::now();
+    gate.release();
+
+    {
+        std::unique_lock<std::mutex> lk(m_);
+        done_cv_.wait(lk, [&]{ return done_ == num_threads_; });
+    }
+    auto t1 = Clock::now();
+
+    // Aggregate results
+    Measurement m;
+    m.seconds = std::chrono::duration<double>(t1 - t0).count();
+    for (const auto& r : results) {
+        m.bytes += r.bytes_processed;
+        m.rfo_bytes += r.rfo_bytes;
+        m.accesses += r.accesses;
+        m.checksum ^= r.checksum; // combine so it's not optimized away
+        m.faults += r.faults;
+        m.counters.add(r.counters);
+    }
+
+    // Start skew and the window in which every thread that did work was
+    // running, from the per-thread gate and finish timestamps
+    Clock::time_point first_start = t1, last_start = t0, first_finish = t1;
+    for (const auto& r : results) {
+        if (r.bytes_processed == 0 && r.accesses == 0) continue;
+        first_start  = std::min(first_start, r.started);
+        last_start   = std::max(last_start, r.started);
+        first_finish = std::min(first_finish, r.finished);
+    }
+    if (last_start > first_start) {
+        m.start_skew = std::chrono::duration<double>(last_start - first_start).count();
+    }
+    m.window = std::max(0.0, std::chrono::duration<double>(first_finish - last_start).count());
+    if (m.window > 0)
+        for (const auto& r : results)
+            if (r.bytes_processed > 0) m.window_bytes += bytes_at(r, first_finish) - bytes_at(r, last_start);
+    m.threads = std::move(results);
+    return m;
+}
+
+} // namespace bst
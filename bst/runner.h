@@ -0,0 +1,177 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "bst/counters.h"
+#include "bst/platform.h"
+#include "bst/simd.h"
+#include "bst/timer.h"
+
+namespace bst {
+
+struct KernelInfo;
+
+// ---------------- Thread runner ----------------
+// A worker's bytes moved over time, so the runner can tell how much of its
+// work fell into the window in which every thread was running. Samples are
+// at least SAMPLE_BYTES apart, which keeps the clock reads out of the
+// measurement; whenever the log fills up every other sample is dropped and
+// the spacing doubles, which bounds it for long --duration runs.
+class ProgressLog {
+public:
+    static const std::uint64_t SAMPLE_BYTES = 1ull << 20;
+    static const size_t CAPACITY = 4096;
+
+    struct Sample {
+        Clock::time_point time;
+        std::uint64_t bytes;
+    };
+
+    // Notes that `bytes` have been moved so far.
+    void add(std::uint64_t bytes) {
+        if (bytes - last_ < spacing_) return;
+        last_ = bytes;
+        samples_.push_back({Clock::now(), bytes});
+        if (samples_.size() == CAPACITY) thin();
+    }
+    const std::vector<Sample>& samples() const { return samples_; }
+
+private:
+    void thin();
+
+    std::vector<Sample> samples_;
+    std::uint64_t last_ = 0;
+    std::uint64_t spacing_ = SAMPLE_BYTES;
+};
+
+// Padded so workers publishing their results never write to a line another
+// worker is using.
+struct alignas(DESTRUCTIVE_INTERFERENCE) ThreadResult {
+    std::uint64_t bytes_processed = 0;
+    std::uint64_t rfo_bytes = 0;    // implicit read-for-ownership traffic
+    std::uint64_t accesses = 0;     // dependent loads (latency mode)
+    std::uint64_t checksum = 0; // prevent optimizing away
+    std::uint64_t faults = 0;       // page faults taken (first-touch phase)
+    CounterValues counters;         // perf_event counts of the timed region
+    ProgressLog progress;           // bytes_processed over time (bandwidth runs)
+    Clock::time_point started;      // when the thread passed the start gate
+    Clock::time_point finished;     // when its worker returned
+    double seconds = 0.0;           // started to finished
+
+    double mbps() const {
+        return seconds > 0 ? static_cast<double>(bytes_processed) / (1024.0 * 1024.0) / seconds : 0.0;
+    }
+};
+
+// Settings resolved once at startup from the Config and the host.
+struct Runtime {
+    const KernelInfo* kernel = nullptr;   // cfg.kernel, from the KernelRegistry
+    SimdKernels       vec;
+    std::vector<int>  cpus;   // CPU per thread id; empty = unpinned
+    bool              counters = false;   // open a CounterSet in every worker
+};
+
+struct Measurement {
+    double        seconds = 0.0;     // gate release to last join
+    double        start_skew = 0.0;  // first to last thread start
+    double        window = 0.0;      // last start to first finish: all threads active
+    std::uint64_t bytes = 0;
+    double        window_bytes = 0.0;  // moved during the window
+    std::uint64_t rfo_bytes = 0;
+    std::uint64_t accesses = 0;
+    std::uint64_t checksum = 0;
+    std::uint64_t faults = 0;
+    CounterValues counters;            // summed over the threads
+    std::vector<ThreadResult> threads; // per-thread results, indexed by tid
+
+    double mbps() const {
+        return seconds > 0 ? static_cast<double>(bytes) / (1024.0 * 1024.0) / seconds : 0.0;
+    }
+    // Bytes moved during the window over its length: the bandwidth while
+    // every thread was running, free of the ramp-up and tail where only
+    // some of them were. NaN when the threads never all ran at once.
+    double concurrent_mbps() const {
+        return window > 0 ? window_bytes / (1024.0 * 1024.0) / window
+                          : std::numeric_limits<double>::quiet_NaN();
+    }
+    double rfo_mbps() const {
+        return seconds > 0 ? static_cast<double>(bytes + rfo_bytes) / (1024.0 * 1024.0) / seconds : 0.0;
+    }
+    // Mean latency of the threads that took dependent loads, each over its
+    // own gate-to-finish time, so neither start skew nor other threads'
+    // tails count. The same per-thread values are the baseline samples.
+    double ns_per_access() const {
+        double sum = 0.0;
+        int n = 0;
+        for (const auto& r : threads) {
+            if (r.accesses == 0) continue;
+            sum += r.seconds * 1e9 / static_cast<double>(r.accesses);
+            ++n;
+        }
+        return n > 0 ? sum / n : 0.0;
+    }
+};
+
+// A fixed set of worker threads, each pinned once to its planned CPU, that
+// runs one job after another. Repeated measurements (warmup, trials) reuse
+// the same threads, so thread creation and pinning stay outside every run.
+class WorkerPool {
+public:
+    using Job = std::function<void(int, StartGate&, ThreadResult&)>;
+
+    WorkerPool(const Runtime& rt, int num_threads) : num_threads_(num_threads), counters_(rt.counters) {
+        threads_.reserve(num_threads);
+        for (int t = 0; t < num_threads; ++t) {
+            const int cpu = rt.cpus.empty() ? -1 : rt.cpus[t];
+            threads_.emplace_back([this, t, cpu] { loop(t, cpu); });
+        }
+    }
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& th : threads_) th.join();
+    }
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int size() const { return num_threads_; }
+
+    // Runs job(tid, gate, result) on every thread, times the region from
+    // gate release to the last finish and folds the per-thread results.
+    // Every job must call gate.wait() exactly once: the gate opens only
+    // after all of them have arrived.
+    Measurement run(const Job& job);
+
+private:
+    void loop(int t, int cpu);
+
+    const int num_threads_;
+    const bool counters_;
+    std::vector<std::thread> threads_;
+    std::mutex m_;
+    std::condition_variable cv_, done_cv_;
+    std::uint64_t generation_ = 0;
+    int done_ = 0;
+    bool stop_ = false;
+    const Job* job_ = nullptr;
+    StartGate* gate_ = nullptr;
+    std::vector<ThreadResult>* results_ = nullptr;
+};
+
+// One-off run on freshly created threads; see WorkerPool::run().
+template <typename Worker>
+Measurement run_threads(const Runtime& rt, int num_threads, Worker&& worker) {
+    WorkerPool pool(rt, num_threads);
+    return pool.run(worker);
+}
+
+} // namespace bst
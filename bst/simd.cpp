@@ -0,0 +1,386 @@
+#include "bst/simd.h"
+
+#include "bst/platform.h"
+
+namespace bst {
+
+// Sequential read/xor/write over [begin, end). Four independent accumulators
+// keep the checksum off the critical path, so the loop is bound by memory
+// rather than by the latency of a single add chain.
+std::uint64_t xor_pass(std::uint64_t* buf, size_t begin, size_t end) {
+    std::uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        const std::uint64_t v0 = buf[i], v1 = buf[i + 1], v2 = buf[i + 2], v3 = buf[i + 3];
+        s0 += v0;
+        s1 += v1;
+        s2 += v2;
+        s3 += v3;
+        buf[i]     = v0 ^ XOR_SEQ_MASK;
+        buf[i + 1] = v1 ^ XOR_SEQ_MASK;
+        buf[i + 2] = v2 ^ XOR_SEQ_MASK;
+        buf[i + 3] = v3 ^ XOR_SEQ_MASK;
+    }
+    for (; i < end; ++i) {
+        const std::uint64_t v = buf[i];
+        s0 += v;
+        buf[i] = v ^ XOR_SEQ_MASK;
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+static const std::uint64_t WRITE_PATTERN = 0x5A5A5A5A5A5A5A5Aull;
+
+static std::uint64_t read_scalar(const std::uint64_t* buf, size_t begin, size_t end) {
+    std::uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        s0 += buf[i];
+        s1 += buf[i + 1];
+        s2 += buf[i + 2];
+        s3 += buf[i + 3];
+    }
+    for (; i < end; ++i) s0 += buf[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+static void write_scalar(std::uint64_t* buf, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) buf[i] = WRITE_PATTERN;
+}
+
+static void copy_scalar(double* dst, const double* src, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) dst[i] = src[i];
+}
+
+#if defined(BST_X86_64)
+
+// 128-bit (SSE2)
+static BST_TARGET("sse2") std::uint64_t read_sse2(const std::uint64_t* buf, size_t begin, size_t end) {
+    __m128i a0 = _mm_setzero_si128(), a1 = a0, a2 = a0, a3 = a0;
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        a0 = _mm_add_epi64(a0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + i)));
+        a1 = _mm_add_epi64(a1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + i + 2)));
+        a2 = _mm_add_epi64(a2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + i + 4)));
+        a3 = _mm_add_epi64(a3, _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + i + 6)));
+    }
+    alignas(16) std::uint64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes),
+                    _mm_add_epi64(_mm_add_epi64(a0, a1), _mm_add_epi64(a2, a3)));
+    return lanes[0] + lanes[1] + read_scalar(buf, i, end);
+}
+
+static BST_TARGET("sse2") void write_sse2(std::uint64_t* buf, size_t begin, size_t end) {
+    const __m128i v = _mm_set1_epi64x(static_cast<long long>(WRITE_PATTERN));
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(buf + i), v);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(buf + i + 2), v);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(buf + i + 4), v);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(buf + i + 6), v);
+    }
+    write_scalar(buf, i, end);
+}
+
+static BST_TARGET("sse2") std::uint64_t rmw_sse2(std::uint64_t* buf, size_t begin, size_t end) {
+    const __m128i mask = _mm_set1_epi64x(static_cast<long long>(XOR_SEQ_MASK));
+    __m128i a0 = _mm_setzero_si128(), a1 = a0;
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128i* p = reinterpret_cast<__m128i*>(buf + i);
+        const __m128i v0 = _mm_loadu_si128(p);
+        const __m128i v1 = _mm_loadu_si128(p + 1);
+        a0 = _mm_add_epi64(a0, v0);
+        a1 = _mm_add_epi64(a1, v1);
+        _mm_storeu_si128(p,     _mm_xor_si128(v0, mask));
+        _mm_storeu_si128(p + 1, _mm_xor_si128(v1, mask));
+    }
+    alignas(16) std::uint64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_add_epi64(a0, a1));
+    return lanes[0] + lanes[1] + xor_pass(buf, i, end);
+}
+
+static BST_TARGET("sse2") void copy_sse2(double* dst, const double* src, size_t begin, size_t end) {
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        const __m128d v0 = _mm_loadu_pd(src + i);
+        const __m128d v1 = _mm_loadu_pd(src + i + 2);
+        const __m128d v2 = _mm_loadu_pd(src + i + 4);
+        const __m128d v3 = _mm_loadu_pd(src + i + 6);
+        _mm_storeu_pd(dst + i,     v0);
+        _mm_storeu_pd(dst + i + 2, v1);
+        _mm_storeu_pd(dst + i + 4, v2);
+        _mm_storeu_pd(dst + i + 6, v3);
+    }
+    copy_scalar(dst, src, i, end);
+}
+
+// 256-bit (AVX2)
+static BST_TARGET("avx2") std::uint64_t read_avx2(const std::uint64_t* buf, size_t begin, size_t end) {
+    __m256i a0 = _mm256_setzero_si256(), a1 = a0, a2 = a0, a3 = a0;
+    size_t i = begin;
+    for (; i + 16 <= end; i += 16) {
+        a0 = _mm256_add_epi64(a0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buf + i)));
+        a1 = _mm256_add_epi64(a1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buf + i + 4)));
+        a2 = _mm256_add_epi64(a2, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buf + i + 8)));
+        a3 = _mm256_add_epi64(a3, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buf + i + 12)));
+    }
+    alignas(32) std::uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes),
+                       _mm256_add_epi64(_mm256_add_epi64(a0, a1), _mm256_add_epi64(a2, a3)));
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + read_scalar(buf, i, end);
+}
+
+static BST_TARGET("avx2") void write_avx2(std::uint64_t* buf, size_t begin, size_t end) {
+    const __m256i v = _mm256_set1_epi64x(static_cast<long long>(WRITE_PATTERN));
+    size_t i = begin;
+    for (; i + 16 <= end; i += 16) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(buf + i), v);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(buf + i + 4), v);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(buf + i + 8), v);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(buf + i + 12), v);
+    }
+    write_scalar(buf, i, end);
+}
+
+static BST_TARGET("avx2") std::uint64_t rmw_avx2(std::uint64_t* buf, size_t begin, size_t end) {
+    const __m256i mask = _mm256_set1_epi64x(static_cast<long long>(XOR_SEQ_MASK));
+    __m256i a0 = _mm256_setzero_si256(), a1 = a0;
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256i* p = reinterpret_cast<__m256i*>(buf + i);
+        const __m256i v0 = _mm256_loadu_si256(p);
+        const __m256i v1 = _mm256_loadu_si256(p + 1);
+        a0 = _mm256_add_epi64(a0, v0);
+        a1 = _mm256_add_epi64(a1, v1);
+        _mm256_storeu_si256(p,     _mm256_xor_si256(v0, mask));
+        _mm256_storeu_si256(p + 1, _mm256_xor_si256(v1, mask));
+    }
+    alignas(32) std::uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(a0, a1));
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + xor_pass(buf, i, end);
+}
+
+static BST_TARGET("avx2") void copy_avx2(double* dst, const double* src, size_t begin, size_t end) {
+    size_t i = begin;
+    for (; i + 16 <= end; i += 16) {
+        const __m256d v0 = _mm256_loadu_pd(src + i);
+        const __m256d v1 = _mm256_loadu_pd(src + i + 4);
+        const __m256d v2 = _mm256_loadu_pd(src + i + 8);
+        const __m256d v3 = _mm256_loadu_pd(src + i + 12);
+        _mm256_storeu_pd(dst + i,      v0);
+        _mm256_storeu_pd(dst + i + 4,  v1);
+        _mm256_storeu_pd(dst + i + 8,  v2);
+        _mm256_storeu_pd(dst + i + 12, v3);
+    }
+    copy_scalar(dst, src, i, end);
+}
+
+// 512-bit (AVX-512F)
+static BST_TARGET("avx512f") std::uint64_t read_avx512(const std::uint64_t* buf, size_t begin, size_t end) {
+    __m512i a0 = _mm512_setzero_si512(), a1 = a0, a2 = a0, a3 = a0;
+    size_t i = begin;
+    for (; i + 32 <= end; i += 32) {
+        a0 = _mm512_add_epi64(a0, _mm512_loadu_si512(buf + i));
+        a1 = _mm512_add_epi64(a1, _mm512_loadu_si512(buf + i + 8));
+        a2 = _mm512_add_epi64(a2, _mm512_loadu_si512(buf + i + 16));
+        a3 = _mm512_add_epi64(a3, _mm512_loadu_si512(buf + i + 24));
+    }
+    alignas(64) std::uint64_t lanes[8];
+    _mm512_store_si512(lanes, _mm512_add_epi64(_mm512_add_epi64(a0, a1), _mm512_add_epi64(a2, a3)));
+    std::uint64_t s = 0;
+    for (std::uint64_t l : lanes) s += l;
+    return s + read_scalar(buf, i, end);
+}
+
+static BST_TARGET("avx512f") void write_avx512(std::uint64_t* buf, size_t begin, size_t end) {
+    const __m512i v = _mm512_set1_epi64(static_cast<long long>(WRITE_PATTERN));
+    size_t i = begin;
+    for (; i + 32 <= end; i += 32) {
+        _mm512_storeu_si512(buf + i, v);
+        _mm512_storeu_si512(buf + i + 8, v);
+        _mm512_storeu_si512(buf + i + 16, v);
+        _mm512_storeu_si512(buf + i + 24, v);
+    }
+    write_scalar(buf, i, end);
+}
+
+static BST_TARGET("avx512f") std::uint64_t rmw_avx512(std::uint64_t* buf, size_t begin, size_t end) {
+    const __m512i mask = _mm512_set1_epi64(static_cast<long long>(XOR_SEQ_MASK));
+    __m512i a0 = _mm512_setzero_si512(), a1 = a0;
+    size_t i = begin;
+    for (; i + 16 <= end; i += 16) {
+        const __m512i v0 = _mm512_loadu_si512(buf + i);
+        const __m512i v1 = _mm512_loadu_si512(buf + i + 8);
+        a0 = _mm512_add_epi64(a0, v0);
+        a1 = _mm512_add_epi64(a1, v1);
+        _mm512_storeu_si512(buf + i,     _mm512_xor_si512(v0, mask));
+        _mm512_storeu_si512(buf + i + 8, _mm512_xor_si512(v1, mask));
+    }
+    alignas(64) std::uint64_t lanes[8];
+    _mm512_store_si512(lanes, _mm512_add_epi64(a0, a1));
+    std::uint64_t s = 0;
+    for (std::uint64_t l : lanes) s += l;
+    return s + xor_pass(buf, i, end);
+}
+
+static BST_TARGET("avx512f") void copy_avx512(double* dst, const double* src, size_t begin, size_t end) {
+    size_t i = begin;
+    for (; i + 32 <= end; i += 32) {
+        const __m512d v0 = _mm512_loadu_pd(src + i);
+        const __m512d v1 = _mm512_loadu_pd(src + i + 8);
+        const __m512d v2 = _mm512_loadu_pd(src + i + 16);
+        const __m512d v3 = _mm512_loadu_pd(src + i + 24);
+        _mm512_storeu_pd(dst + i,      v0);
+        _mm512_storeu_pd(dst + i + 8,  v1);
+        _mm512_storeu_pd(dst + i + 16, v2);
+        _mm512_storeu_pd(dst + i + 24, v3);
+    }
+    copy_scalar(dst, src, i, end);
+}
+
+// Non-temporal (streaming) stores bypass the cache, so the destination is
+// never read for ownership. Streaming stores need an aligned address: peel a
+// scalar head up to the vector width, stream the body, finish with a scalar
+// tail, and fence once per pass so the stores are globally visible.
+template <typename T>
+static size_t aligned_start(const T* p, size_t begin, size_t end, size_t align) {
+    size_t i = begin;
+    while (i < end && (reinterpret_cast<std::uintptr_t>(p + i) & (align - 1)) != 0) ++i;
+    return i;
+}
+
+static BST_TARGET("sse2") void write_nt_sse2(std::uint64_t* buf, size_t begin, size_t end) {
+    const __m128i v = _mm_set1_epi64x(static_cast<long long>(WRITE_PATTERN));
+    size_t i = aligned_start(buf, begin, end, 16);
+    write_scalar(buf, begin, i);
+    for (; i + 8 <= end; i += 8) {
+        _mm_stream_si128(reinterpret_cast<__m128i*>(buf + i), v);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(buf + i + 2), v);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(buf + i + 4), v);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(buf + i + 6), v);
+    }
+    write_scalar(buf, i, end);
+    _mm_sfence();
+}
+
+static BST_TARGET("sse2") void copy_nt_sse2(double* dst, const double* src, size_t begin, size_t end) {
+    size_t i = aligned_start(dst, begin, end, 16);
+    copy_scalar(dst, src, begin, i);
+    for (; i + 8 <= end; i += 8) {
+        const __m128d v0 = _mm_loadu_pd(src + i);
+        const __m128d v1 = _mm_loadu_pd(src + i + 2);
+        const __m128d v2 = _mm_loadu_pd(src + i + 4);
+        const __m128d v3 = _mm_loadu_pd(src + i + 6);
+        _mm_stream_pd(dst + i,     v0);
+        _mm_stream_pd(dst + i + 2, v1);
+        _mm_stream_pd(dst + i + 4, v2);
+        _mm_stream_pd(dst + i + 6, v3);
+    }
+    copy_scalar(dst, src, i, end);
+    _mm_sfence();
+}
+
+static BST_TARGET("avx2") void write_nt_avx2(std::uint64_t* buf, size_t begin, size_t end) {
+    const __m256i v = _mm256_set1_epi64x(static_cast<long long>(WRITE_PATTERN));
+    size_t i = aligned_start(buf, begin, end, 32);
+    write_scalar(buf, begin, i);
+    for (; i + 16 <= end; i += 16) {
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(buf + i), v);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(buf + i + 4), v);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(buf + i + 8), v);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(buf + i + 12), v);
+    }
+    write_scalar(buf, i, end);
+    _mm_sfence();
+}
+
+static BST_TARGET("avx2") void copy_nt_avx2(double* dst, const double* src, size_t begin, size_t end) {
+    size_t i = aligned_start(dst, begin, end, 32);
+    copy_scalar(dst, src, begin, i);
+    for (; i + 16 <= end; i += 16) {
+        const __m256d v0 = _mm256_loadu_pd(src + i);
+        const __m256d v1 = _mm256_loadu_pd(src + i + 4);
+        const __m256d v2 = _mm256_loadu_pd(src + i + 8);
+        const __m256d v3 = _mm256_loadu_pd(src + i + 12);
+        _mm256_stream_pd(dst + i,      v0);
+        _mm256_stream_pd(dst + i + 4,  v1);
+        _mm256_stream_pd(dst + i + 8,  v2);
+        _mm256_stream_pd(dst + i + 12, v3);
+    }
+    copy_scalar(dst, src, i, end);
+    _mm_sfence();
+}
+
+static BST_TARGET("avx512f") void write_nt_avx512(std::uint64_t* buf, size_t begin, size_t end) {
+    const __m512i v = _mm512_set1_epi64(static_cast<long long>(WRITE_PATTERN));
+    size_t i = aligned_start(buf, begin, end, 64);
+    write_scalar(buf, begin, i);
+    for (; i + 32 <= end; i += 32) {
+        _mm512_stream_si512(reinterpret_cast<__m512i*>(buf + i), v);
+        _mm512_stream_si512(reinterpret_cast<__m512i*>(buf + i + 8), v);
+        _mm512_stream_si512(reinterpret_cast<__m512i*>(buf + i + 16), v);
+        _mm512_stream_si512(reinterpret_cast<__m512i*>(buf + i + 24), v);
+    }
+    write_scalar(buf, i, end);
+    _mm_sfence();
+}
+
+static BST_TARGET("avx512f") void copy_nt_avx512(double* dst, const double* src, size_t begin, size_t end) {
+    size_t i = aligned_start(dst, begin, end, 64);
+    copy_scalar(dst, src, begin, i);
+    for (; i + 32 <= end; i += 32) {
+        const __m512d v0 = _mm512_loadu_pd(src + i);
+        const __m512d v1 = _mm512_loadu_pd(src + i + 8);
+        const __m512d v2 = _mm512_loadu_pd(src + i + 16);
+        const __m512d v3 = _mm512_loadu_pd(src + i + 24);
+        _mm512_stream_pd(dst + i,      v0);
+        _mm512_stream_pd(dst + i + 8,  v1);
+        _mm512_stream_pd(dst + i + 16, v2);
+        _mm512_stream_pd(dst + i + 24, v3);
+    }
+    copy_scalar(dst, src, i, end);
+    _mm_sfence();
+}
+#endif // x86-64
+
+Simd detect_simd() {
+#if defined(BST_X86_64) && defined(_MSC_VER) && !defined(__clang__)
+    int r[4];
+    __cpuid(r, 0);
+    const int max_leaf = r[0];
+    __cpuid(r, 1);
+    const bool osxsave = (r[2] & (1 << 27)) != 0;
+    const bool avx     = (r[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || max_leaf < 7) return Simd::SSE2;
+    const unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(r, 7, 0);
+    if ((xcr0 & 0xE6) == 0xE6 && (r[1] & (1 << 16))) return Simd::AVX512;
+    if ((xcr0 & 0x06) == 0x06 && (r[1] & (1 << 5)))  return Simd::AVX2;
+    return Simd::SSE2;
+#elif defined(BST_X86_64)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return Simd::AVX512;
+    if (__builtin_cpu_supports("avx2"))    return Simd::AVX2;
+    return Simd::SSE2;
+#else
+    return Simd::Scalar;
+#endif
+}
+
+SimdKernels simd_kernels(Simd s) {
+    switch (s) {
+#if defined(BST_X86_64)
+    case Simd::SSE2:
+        return {read_sse2,   write_sse2,   rmw_sse2,   copy_sse2,   write_nt_sse2,   copy_nt_sse2};
+    case Simd::AVX2:
+        return {read_avx2,   write_avx2,   rmw_avx2,   copy_avx2,   write_nt_avx2,   copy_nt_avx2};
+    case Simd::AVX512:
+        return {read_avx512, write_avx512, rmw_avx512, copy_avx512, write_nt_avx512, copy_nt_avx512};
+#endif
+    default:
+        return {read_scalar, write_scalar, xor_pass,   copy_scalar, nullptr,         nullptr};
+    }
+}
+
+} // namespace bst
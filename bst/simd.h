@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "bst/config.h"
+
+namespace bst {
+
+// ---------------- SIMD kernels ----------------
+// Hand-written read / write / read-modify-write / copy loops at 128, 256 and
+// 512-bit widths. Each ISA level is compiled with a function-level target
+// attribute so the binary runs anywhere; the level is picked at startup from
+// CPUID (or forced with --simd). All widths produce the same checksum as the
+// scalar loops: the sum of every word read.
+struct SimdKernels {
+    std::uint64_t (*read)(const std::uint64_t* buf, size_t begin, size_t end);
+    void          (*write)(std::uint64_t* buf, size_t begin, size_t end);
+    std::uint64_t (*rmw)(std::uint64_t* buf, size_t begin, size_t end);
+    void          (*copy)(double* dst, const double* src, size_t begin, size_t end);
+    void          (*write_nt)(std::uint64_t* buf, size_t begin, size_t end);   // null if unsupported
+    void          (*copy_nt)(double* dst, const double* src, size_t begin, size_t end);
+};
+
+static const std::uint64_t XOR_SEQ_MASK  = 0xA5A5A5A5A5A5A5A5ull;
+static const std::uint64_t XOR_RAND_MASK = 0xDEADBEEFCAFEBABEull;
+
+// Scalar sequential read/xor/write over [begin, end), the rmw loop of
+// Simd::Scalar. Returns the sum of the words read.
+std::uint64_t xor_pass(std::uint64_t* buf, size_t begin, size_t end);
+
+// Widest level supported by both the CPU and the OS (AVX state must be
+// enabled in XCR0, not just advertised by CPUID).
+Simd detect_simd();
+
+SimdKernels simd_kernels(Simd s);
+
+} // namespace bst
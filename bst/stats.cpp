@@ -0,0 +1,69 @@
+#include "bst/stats.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace bst {
+
+double student_t95(int df) {
+    static const double table[] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+    };
+    if (df < 1) return 0.0;
+    if (df <= 30) return table[df - 1];
+    return df <= 60 ? 2.000 : df <= 120 ? 1.980 : 1.960;
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    const double rank = p / 100.0 * static_cast<double>(sorted.size() - 1);
+    const size_t lo = static_cast<size_t>(rank);
+    const size_t hi = std::min(sorted.size() - 1, lo + 1);
+    return sorted[lo] + (sorted[hi] - sorted[lo]) * (rank - static_cast<double>(lo));
+}
+
+TrialStats trial_stats(const std::vector<Measurement>& trials) {
+    std::vector<double> v;
+    for (const auto& m : trials) v.push_back(m.mbps());
+    std::sort(v.begin(), v.end());
+    TrialStats st;
+    if (v.empty()) return st;
+    const size_t n = v.size();
+    st.min = v.front();
+    st.max = v.back();
+    st.median = percentile(v, 50.0);
+    st.p90 = percentile(v, 90.0);
+    for (double x : v) st.mean += x;
+    st.mean /= static_cast<double>(n);
+    if (n > 1) {
+        double var = 0.0;
+        for (double x : v) var += (x - st.mean) * (x - st.mean);
+        st.stddev = std::sqrt(var / static_cast<double>(n - 1));
+        st.ci = student_t95(static_cast<int>(n - 1)) * st.stddev / std::sqrt(static_cast<double>(n));
+    }
+    return st;
+}
+
+size_t median_trial(const std::vector<Measurement>& trials) {
+    std::vector<size_t> order(trials.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(),
+              [&](size_t a, size_t b) { return trials[a].mbps() < trials[b].mbps(); });
+    return order[(order.size() - 1) / 2];
+}
+
+double sample_mean(const std::vector<double>& v) {
+    double sum = 0.0;
+    for (double x : v) sum += x;
+    return v.empty() ? 0.0 : sum / static_cast<double>(v.size());
+}
+
+double sample_variance(const std::vector<double>& v, double mean) {
+    if (v.size() < 2) return 0.0;
+    double sum = 0.0;
+    for (double x : v) sum += (x - mean) * (x - mean);
+    return sum / static_cast<double>(v.size() - 1);
+}
+
+} // namespace bst
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "bst/runner.h"
+
+namespace bst {
+
+// ---------------- Statistics ----------------
+// Two-sided 95% critical value of Student's t with `df` degrees of freedom.
+double student_t95(int df);
+
+// Order statistics, mean, sample stddev and 95% confidence interval of
+// the mean over a set of throughput samples.
+struct TrialStats {
+    double min = 0.0, median = 0.0, mean = 0.0, p90 = 0.0, max = 0.0;
+    double stddev = 0.0;
+    double ci = 0.0;      // half-width of the 95% CI of the mean
+
+    double ci_percent() const { return mean > 0 ? ci / mean * 100.0 : 0.0; }
+};
+
+// Linear interpolation between closest ranks of an ascending sample.
+double percentile(const std::vector<double>& sorted, double p);
+
+TrialStats trial_stats(const std::vector<Measurement>& trials);
+
+// Index of the trial with the median throughput (the lower one of the
+// two middle trials for an even count).
+size_t median_trial(const std::vector<Measurement>& trials);
+
+double sample_mean(const std::vector<double>& v);
+double sample_variance(const std::vector<double>& v, double mean);
+
+} // namespace bst
@@ -0,0 +1,49 @@
+#include "bst/timer.h"
+
+#include <limits>
+
+#include "bst/counters.h"
+#include "bst/platform.h"
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bst {
+
+thread_local Clock::time_point gate_passed_at;
+
+void StartGate::wait() {
+    arrived.fetch_add(1, std::memory_order_acq_rel);
+    for (int i = 0; spin && i < SPIN_ITERATIONS; ++i) {
+        if (go.load(std::memory_order_acquire)) break;
+        cpu_relax();
+    }
+    while (!go.load(std::memory_order_acquire)) {
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&go), FUTEX_WAIT_PRIVATE, 0u,
+                nullptr, nullptr, 0);
+#else
+        std::unique_lock<std::mutex> lk(m);
+        cv.wait(lk, [&]{ return go.load(std::memory_order_acquire) != 0; });
+#endif
+    }
+    gate_passed_at = Clock::now();
+    if (thread_counters) thread_counters->start();
+}
+
+void StartGate::release() {
+    released_at = Clock::now();
+    go.store(1, std::memory_order_release);
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&go), FUTEX_WAKE_PRIVATE,
+            std::numeric_limits<int>::max(), nullptr, nullptr, 0);
+#else
+    { std::lock_guard<std::mutex> lk(m); }
+    cv.notify_all();
+#endif
+}
+
+} // namespace bst
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if !defined(__linux__)
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace bst {
+
+using Clock = std::chrono::high_resolution_clock;
+
+inline Clock::duration to_clock(double seconds) {
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+// Time at which the calling thread last passed a StartGate.
+extern thread_local Clock::time_point gate_passed_at;
+
+// Start barrier. Waiters spin on an atomic flag so they all leave within
+// nanoseconds of release(); when the threads outnumber the CPUs spinning
+// would starve the releasing thread, so they go straight to sleeping on a
+// futex (a condition variable off Linux). The releasing side can wait until
+// every worker has arrived, so no worker starts while others are still
+// being created.
+struct StartGate {
+    static const int SPIN_ITERATIONS = 1 << 14;
+
+    std::atomic<std::uint32_t> go{0};
+    std::atomic<int> arrived{0};
+    bool spin = true;
+    Clock::time_point released_at;  // valid for waiters once they have passed
+#if !defined(__linux__)
+    std::mutex m;
+    std::condition_variable cv;
+#endif
+
+    // Blocks until release(), then records gate_passed_at and starts the
+    // calling thread's counters.
+    void wait();
+    void wait_for_arrivals(int n) const {
+        while (arrived.load(std::memory_order_acquire) < n) std::this_thread::yield();
+    }
+    void release();
+};
+
+} // namespace bst
@@ -0,0 +1,148 @@
+#include "bst/topology.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+#include "bst/config.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace bst {
+
+#if defined(__linux__)
+static int read_sysfs_int(const std::string& path, int fallback) {
+    std::ifstream in(path);
+    int v = 0;
+    return (in >> v) ? v : fallback;
+}
+
+static std::vector<int> allowed_cpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int c = 0; c < CPU_SETSIZE; ++c)
+            if (CPU_ISSET(c, &set)) cpus.push_back(c);
+    }
+    return cpus;
+}
+#endif
+
+std::vector<CpuInfo> read_topology() {
+    std::vector<CpuInfo> topo;
+#if defined(__linux__)
+    for (int c : allowed_cpus()) {
+        const std::string dir = "/sys/devices/system/cpu/cpu" + std::to_string(c) + "/topology/";
+        topo.push_back({c, read_sysfs_int(dir + "physical_package_id", 0),
+                        read_sysfs_int(dir + "core_id", c), 0});
+    }
+    std::sort(topo.begin(), topo.end(), [](const CpuInfo& x, const CpuInfo& y) {
+        return std::tie(x.package, x.core, x.cpu) < std::tie(y.package, y.core, y.cpu);
+    });
+    for (size_t i = 1; i < topo.size(); ++i)
+        if (topo[i].package == topo[i - 1].package && topo[i].core == topo[i - 1].core)
+            topo[i].smt = topo[i - 1].smt + 1;
+#endif
+    return topo;
+}
+
+std::vector<int> plan_affinity(const Config& cfg) {
+    if (cfg.affinity == Affinity::None) return {};
+    std::vector<int> order;
+    if (cfg.affinity == Affinity::List) {
+        order = cfg.cpu_list;
+#if defined(__linux__)
+        const std::vector<int> allowed = allowed_cpus();
+        for (int c : order)
+            if (std::find(allowed.begin(), allowed.end(), c) == allowed.end())
+                throw std::runtime_error("CPU " + std::to_string(c) + " is not available to this process");
+#endif
+    } else {
+        std::vector<CpuInfo> topo = read_topology();
+        if (topo.empty()) throw std::runtime_error("could not determine the available CPUs");
+        switch (cfg.affinity) {
+        case Affinity::Compact:
+            // Fill a core's hardware threads, then the next core, then the next socket
+            break;
+        case Affinity::Scatter: {
+            // One thread per core, alternating sockets, before any SMT sibling
+            std::stable_sort(topo.begin(), topo.end(), [](const CpuInfo& x, const CpuInfo& y) {
+                return std::tie(x.smt, x.core) < std::tie(y.smt, y.core);
+            });
+            std::vector<CpuInfo> interleaved;
+            std::vector<int> packages;
+            for (const auto& c : topo)
+                if (std::find(packages.begin(), packages.end(), c.package) == packages.end())
+                    packages.push_back(c.package);
+            std::vector<std::vector<CpuInfo>> per_pkg(packages.size());
+            for (const auto& c : topo)
+                per_pkg[std::find(packages.begin(), packages.end(), c.package) - packages.begin()].push_back(c);
+            for (size_t i = 0; interleaved.size() < topo.size(); ++i)
+                for (const auto& p : per_pkg)
+                    if (i < p.size()) interleaved.push_back(p[i]);
+            topo = interleaved;
+            break;
+        }
+        case Affinity::NoSmt:
+            topo.erase(std::remove_if(topo.begin(), topo.end(),
+                                      [](const CpuInfo& c) { return c.smt != 0; }), topo.end());
+            break;
+        default:
+            break;
+        }
+        for (const auto& c : topo) order.push_back(c.cpu);
+    }
+
+    std::vector<int> plan(cfg.threads);
+    for (int t = 0; t < cfg.threads; ++t)
+        plan[t] = order[static_cast<size_t>(t) % order.size()];
+    return plan;
+}
+
+void pin_current_thread(int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    const int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0)
+        std::cerr << "Warning: could not pin thread to CPU " << cpu << ": " << std::strerror(rc) << "\n";
+#else
+    (void)cpu;
+#endif
+}
+
+NumaTopology read_numa_topology() {
+    NumaTopology topo;
+#if defined(__linux__)
+    std::ifstream online("/sys/devices/system/node/online");
+    std::string line;
+    if (online && std::getline(online, line)) {
+        try {
+            topo.nodes = parse_cpu_list("node list", trim(line));
+        } catch (const std::exception&) {
+            topo.nodes.clear();
+        }
+    }
+    for (int node : topo.nodes) {
+        std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!in || !std::getline(in, line) || trim(line).empty()) continue;
+        for (int cpu : parse_cpu_list("cpulist", trim(line))) {
+            if (static_cast<size_t>(cpu) >= topo.cpu_node.size()) topo.cpu_node.resize(cpu + 1, node);
+            topo.cpu_node[cpu] = node;
+        }
+    }
+#endif
+    if (topo.nodes.empty()) topo.nodes.push_back(0);
+    return topo;
+}
+
+} // namespace bst
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace bst {
+
+struct Config;
+
+// ---------------- Thread placement ----------------
+// CPUs this process may run on, with their socket / core / SMT position.
+struct CpuInfo {
+    int cpu;
+    int package;
+    int core;
+    int smt;    // index among the hardware threads of the same core
+};
+
+// Topology of the allowed CPUs, from /sys/devices/system/cpu. Missing
+// entries degrade to one package with one core per CPU.
+std::vector<CpuInfo> read_topology();
+
+// CPU for each thread id under cfg.affinity; empty means leave threads
+// unpinned. Thread counts beyond the available CPUs wrap around.
+std::vector<int> plan_affinity(const Config& cfg);
+
+// Binds the calling thread to one CPU.
+void pin_current_thread(int cpu);
+
+// NUMA nodes and the node of every CPU, from /sys/devices/system/node.
+// Hosts without that directory (or non-Linux) look like a single node 0.
+struct NumaTopology {
+    std::vector<int> nodes;
+    std::vector<int> cpu_node;   // indexed by CPU id
+
+    int node_of(int cpu) const {
+        return cpu >= 0 && static_cast<size_t>(cpu) < cpu_node.size() ? cpu_node[cpu] : nodes.front();
+    }
+};
+
+NumaTopology read_numa_topology();
+
+} // namespace bst
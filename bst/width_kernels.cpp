@@ -0,0 +1,202 @@
+// Access-width kernels: load, store and read-modify-write loops over buf,
+// specialised at compile time on element size (8 to 64 bytes), unroll depth
+// and stride, for studying how the width of each access affects the
+// bandwidth achieved. A curated set of instantiations is registered below.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "bst/buffer.h"
+#include "bst/config.h"
+#include "bst/kernel.h"
+#include "bst/platform.h"
+
+namespace bst {
+
+enum class WidthOp { Load, Store, Rmw };
+
+static const std::uint64_t WIDTH_PATTERN = 0x3C3C3C3C3C3C3C3Cull;
+
+// ---------------- Elements ----------------
+// One element type per access width. Vec holds an element in registers;
+// load and store move a whole element with one access, and fold reduces
+// it to the 64-bit checksum.
+
+// 8 bytes. The accesses go through volatile so the compiler cannot merge
+// neighbouring words into wider vector accesses, which would defeat the
+// point of an 8-byte kernel.
+struct ScalarElement {
+    using Vec = std::uint64_t;
+    static const size_t WORDS = 1;
+    static Vec zero() { return 0; }
+    static Vec splat(std::uint64_t v) { return v; }
+    static Vec load(const std::uint64_t* p) { return *static_cast<const volatile std::uint64_t*>(p); }
+    static void store(std::uint64_t* p, const Vec& v) { *static_cast<volatile std::uint64_t*>(p) = v; }
+    static Vec bxor(const Vec& a, const Vec& b) { return a ^ b; }
+    static std::uint64_t fold(const Vec& v) { return v; }
+};
+
+#if defined(BST_X86_64)
+
+// 16 bytes. SSE2 is part of x86-64, so no target attribute is needed.
+struct Sse2Element {
+    using Vec = __m128i;
+    static const size_t WORDS = 2;
+    static Vec zero() { return _mm_setzero_si128(); }
+    static Vec splat(std::uint64_t v) { return _mm_set1_epi64x(static_cast<long long>(v)); }
+    static Vec load(const std::uint64_t* p) { return _mm_load_si128(reinterpret_cast<const __m128i*>(p)); }
+    static void store(std::uint64_t* p, const Vec& v) { _mm_store_si128(reinterpret_cast<__m128i*>(p), v); }
+    static Vec bxor(const Vec& a, const Vec& b) { return _mm_xor_si128(a, b); }
+    static std::uint64_t fold(const Vec& v) {
+        alignas(16) std::uint64_t lanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), v);
+        return lanes[0] ^ lanes[1];
+    }
+};
+
+// 32 bytes
+struct Avx2Element {
+    using Vec = __m256i;
+    static const size_t WORDS = 4;
+    static BST_TARGET("avx2") Vec zero() { return _mm256_setzero_si256(); }
+    static BST_TARGET("avx2") Vec splat(std::uint64_t v) { return _mm256_set1_epi64x(static_cast<long long>(v)); }
+    static BST_TARGET("avx2") Vec load(const std::uint64_t* p) {
+        return _mm256_load_si256(reinterpret_cast<const __m256i*>(p));
+    }
+    static BST_TARGET("avx2") void store(std::uint64_t* p, const Vec& v) {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(p), v);
+    }
+    static BST_TARGET("avx2") Vec bxor(const Vec& a, const Vec& b) { return _mm256_xor_si256(a, b); }
+    static BST_TARGET("avx2") std::uint64_t fold(const Vec& v) {
+        alignas(32) std::uint64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), v);
+        return (lanes[0] ^ lanes[1]) ^ (lanes[2] ^ lanes[3]);
+    }
+};
+
+// 64 bytes: a whole cache line per access
+struct Avx512Element {
+    using Vec = __m512i;
+    static const size_t WORDS = 8;
+    static BST_TARGET("avx512f") Vec zero() { return _mm512_setzero_si512(); }
+    static BST_TARGET("avx512f") Vec splat(std::uint64_t v) { return _mm512_set1_epi64(static_cast<long long>(v)); }
+    static BST_TARGET("avx512f") Vec load(const std::uint64_t* p) { return _mm512_load_si512(p); }
+    static BST_TARGET("avx512f") void store(std::uint64_t* p, const Vec& v) { _mm512_store_si512(p, v); }
+    static BST_TARGET("avx512f") Vec bxor(const Vec& a, const Vec& b) { return _mm512_xor_si512(a, b); }
+    static BST_TARGET("avx512f") std::uint64_t fold(const Vec& v) {
+        alignas(64) std::uint64_t lanes[8];
+        _mm512_store_si512(lanes, v);
+        std::uint64_t s = 0;
+        for (std::uint64_t l : lanes) s ^= l;
+        return s;
+    }
+};
+
+#else
+
+// Elsewhere, N words per element, moved as the compiler sees fit
+template <size_t N>
+struct WordsElement {
+    struct Vec { std::uint64_t w[N]; };
+    static const size_t WORDS = N;
+    static Vec zero() { return splat(0); }
+    static Vec splat(std::uint64_t v) {
+        Vec r;
+        for (std::uint64_t& x : r.w) x = v;
+        return r;
+    }
+    static Vec load(const std::uint64_t* p) {
+        Vec r;
+        for (size_t i = 0; i < N; ++i) r.w[i] = p[i];
+        return r;
+    }
+    static void store(std::uint64_t* p, const Vec& v) {
+        for (size_t i = 0; i < N; ++i) p[i] = v.w[i];
+    }
+    static Vec bxor(const Vec& a, const Vec& b) {
+        Vec r;
+        for (size_t i = 0; i < N; ++i) r.w[i] = a.w[i] ^ b.w[i];
+        return r;
+    }
+    static std::uint64_t fold(const Vec& v) {
+        std::uint64_t s = 0;
+        for (std::uint64_t x : v.w) s ^= x;
+        return s;
+    }
+};
+
+#endif
+
+// ---------------- Loops ----------------
+#define BST_WIDTH_TARGET
+namespace generic {
+#include "bst/width_loop.inc"
+}
+#undef BST_WIDTH_TARGET
+
+#if defined(BST_X86_64)
+#define BST_WIDTH_TARGET BST_TARGET("avx2")
+namespace avx2 {
+#include "bst/width_loop.inc"
+}
+#undef BST_WIDTH_TARGET
+
+#define BST_WIDTH_TARGET BST_TARGET("avx512f")
+namespace avx512 {
+#include "bst/width_loop.inc"
+}
+#undef BST_WIDTH_TARGET
+#endif
+
+// ---------------- Registration ----------------
+// Pass and required instruction set per element size
+template <WidthOp Op, int Unroll, int Stride>
+constexpr KernelPass pass8 = generic::width_kernel<ScalarElement, Op, Unroll, Stride>;
+#if defined(BST_X86_64)
+template <WidthOp Op, int Unroll, int Stride>
+constexpr KernelPass pass16 = generic::width_kernel<Sse2Element, Op, Unroll, Stride>;
+template <WidthOp Op, int Unroll, int Stride>
+constexpr KernelPass pass32 = avx2::width_kernel<Avx2Element, Op, Unroll, Stride>;
+template <WidthOp Op, int Unroll, int Stride>
+constexpr KernelPass pass64 = avx512::width_kernel<Avx512Element, Op, Unroll, Stride>;
+static const Simd ISA16 = Simd::SSE2, ISA32 = Simd::AVX2, ISA64 = Simd::AVX512;
+#else
+template <WidthOp Op, int Unroll, int Stride>
+constexpr KernelPass pass16 = generic::width_kernel<WordsElement<2>, Op, Unroll, Stride>;
+template <WidthOp Op, int Unroll, int Stride>
+constexpr KernelPass pass32 = generic::width_kernel<WordsElement<4>, Op, Unroll, Stride>;
+template <WidthOp Op, int Unroll, int Stride>
+constexpr KernelPass pass64 = generic::width_kernel<WordsElement<8>, Op, Unroll, Stride>;
+static const Simd ISA16 = Simd::Scalar, ISA32 = Simd::Scalar, ISA64 = Simd::Scalar;
+#endif
+
+static const WidthOp LOAD = WidthOp::Load, STORE = WidthOp::Store, RMW = WidthOp::Rmw;
+
+// Every width for each operation at unroll 4, then unroll depth and
+// stride at the narrowest and widest element.
+static const KernelRegistrar width_kernels[] = {
+    KernelRegistrar({"load8",  1, 0, "sum ^= e[i], 8 B, unroll 4",  0, pass8<LOAD, 4, 1>,  1, Simd::Scalar}),
+    KernelRegistrar({"load16", 1, 0, "sum ^= e[i], 16 B, unroll 4", 0, pass16<LOAD, 4, 1>, 1, ISA16}),
+    KernelRegistrar({"load32", 1, 0, "sum ^= e[i], 32 B, unroll 4", 0, pass32<LOAD, 4, 1>, 1, ISA32}),
+    KernelRegistrar({"load64", 1, 0, "sum ^= e[i], 64 B, unroll 4", 0, pass64<LOAD, 4, 1>, 1, ISA64}),
+    KernelRegistrar({"store8",  1, 1, "e[i] = K, 8 B, unroll 4",  0, pass8<STORE, 4, 1>,  1, Simd::Scalar}),
+    KernelRegistrar({"store16", 1, 1, "e[i] = K, 16 B, unroll 4", 0, pass16<STORE, 4, 1>, 1, ISA16}),
+    KernelRegistrar({"store32", 1, 1, "e[i] = K, 32 B, unroll 4", 0, pass32<STORE, 4, 1>, 1, ISA32}),
+    KernelRegistrar({"store64", 1, 1, "e[i] = K, 64 B, unroll 4", 0, pass64<STORE, 4, 1>, 1, ISA64}),
+    KernelRegistrar({"rmw8",  2, 0, "e[i] ^= K, 8 B, unroll 4",  0, pass8<RMW, 4, 1>,  1, Simd::Scalar}),
+    KernelRegistrar({"rmw16", 2, 0, "e[i] ^= K, 16 B, unroll 4", 0, pass16<RMW, 4, 1>, 1, ISA16}),
+    KernelRegistrar({"rmw32", 2, 0, "e[i] ^= K, 32 B, unroll 4", 0, pass32<RMW, 4, 1>, 1, ISA32}),
+    KernelRegistrar({"rmw64", 2, 0, "e[i] ^= K, 64 B, unroll 4", 0, pass64<RMW, 4, 1>, 1, ISA64}),
+    KernelRegistrar({"load8-u1",  1, 0, "sum ^= e[i], 8 B, unroll 1",  0, pass8<LOAD, 1, 1>,  1, Simd::Scalar}),
+    KernelRegistrar({"load8-u8",  1, 0, "sum ^= e[i], 8 B, unroll 8",  0, pass8<LOAD, 8, 1>,  1, Simd::Scalar}),
+    KernelRegistrar({"load64-u1", 1, 0, "sum ^= e[i], 64 B, unroll 1", 0, pass64<LOAD, 1, 1>, 1, ISA64}),
+    KernelRegistrar({"load64-u8", 1, 0, "sum ^= e[i], 64 B, unroll 8", 0, pass64<LOAD, 8, 1>, 1, ISA64}),
+    KernelRegistrar({"load8-s2",  1, 0, "sum ^= e[2i], 8 B, unroll 4",  0, pass8<LOAD, 4, 2>,  2, Simd::Scalar}),
+    KernelRegistrar({"load8-s4",  1, 0, "sum ^= e[4i], 8 B, unroll 4",  0, pass8<LOAD, 4, 4>,  4, Simd::Scalar}),
+    KernelRegistrar({"load8-s8",  1, 0, "sum ^= e[8i], 8 B, unroll 4",  0, pass8<LOAD, 4, 8>,  8, Simd::Scalar}),
+    KernelRegistrar({"load64-s2", 1, 0, "sum ^= e[2i], 64 B, unroll 4", 0, pass64<LOAD, 4, 2>, 2, ISA64}),
+};
+
+} // namespace bst
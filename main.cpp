@@ -1,157 +1,471 @@
+// Memory bandwidth saturation test: command-line front end of the bst
+// library (bst/). Parses the options, sets up threads and buffers and
+// prints the report.
+
 #include <algorithm>
-#include <atomic>
+#include <cerrno>
 #include <chrono>
-#include <condition_variable>
 #include <cstdint>
 #include <cstring>
+#include <exception>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
-#include <mutex>
-#include <random>
+#include <new>
+#include <stdexcept>
+#include <streambuf>
 #include <string>
-#include <thread>
-#include <vector>
-
-// ---------------- Configuration ----------------
-static const int    NUM_THREADS  = 8;                            // default threads
-static const size_t BUFFER_SIZE  = 512ull * 1024ull * 1024ull;   // 512 MB
-static const int    ITERATIONS   = 10;                           // loops over buffer
-// ------------------------------------------------------------
-
-using Clock = std::chrono::high_resolution_clock;
-
-struct StartGate {
-    std::mutex m;
-    std::condition_variable cv;
-    bool go = false;
-    void wait() {
-        std::unique_lock<std::mutex> lk(m);
-        cv.wait(lk, [&]{ return go; });
-    }
-    void release() {
-        std::lock_guard<std::mutex> lk(m);
-        go = true;
-        cv.notify_all();
+
+#include "bst/benchmarks.h"
+#include "bst/buffer.h"
+#include "bst/config.h"
+#include "bst/counters.h"
+#include "bst/kernel.h"
+#include "bst/report.h"
+#include "bst/runner.h"
+#include "bst/simd.h"
+#include "bst/stats.h"
+#include "bst/timer.h"
+#include "bst/topology.h"
+
+using namespace bst;
+
+// ---------------- Option parsing ----------------
+// Registered kernel names, wrapped to the width of the option help.
+static std::string kernel_list() {
+    std::string out, line;
+    for (const KernelInfo& k : KernelRegistry::instance().kernels()) {
+        if (!line.empty() && line.size() + std::strlen(k.name) + 3 > 56) {
+            out += line + " |\n                       ";
+            line.clear();
+        }
+        line += (line.empty() ? "" : " | ") + std::string(k.name);
     }
-};
+    return out + line;
+}
+
+static void print_usage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options]\n"
+              << "  -k, --kernel K       " << kernel_list() << "\n"
+              << "                       (default xor)\n"
+              << "  -t, --threads N      worker threads (default " << DEFAULT_THREADS << ")\n"
+              << "  -s, --size SIZE      buffer size (per array for STREAM kernels),\n"
+              << "                       K/M/G suffixes allowed (default 512M)\n"
+              << "  -i, --iterations N   passes over the buffer (default " << DEFAULT_ITERATIONS << ")\n"
+              << "  -p, --pattern P      access pattern: seq | random (default seq)\n"
+              << "  -r, --random         shorthand for --pattern random\n"
+              << "  -a, --affinity P     thread pinning: none | compact | scatter | nosmt | list\n"
+              << "                       (default none)\n"
+              << "      --cpus LIST      pin threads to these CPUs, e.g. 0,2,4-7 (implies list)\n"
+              << "      --numa P         page placement: first-touch | local | remote | interleave\n"
+              << "                       (default first-touch)\n"
+              << "      --pages P        buffer pages: default | thp | 2m | 1g (hugetlb, falls back\n"
+              << "                       to smaller pages when unavailable; default: default)\n"
+              << "      --prefault M     fault pages in before timing: touch | populate | madvise\n"
+              << "                       (default touch)\n"
+              << "      --seed N         PRNG seed for random access\n"
+              << "      --rng G          random index generator: mt | xorshift | splitmix | wyrand\n"
+              << "                       (default mt)\n"
+              << "      --pregen         generate random indices before the timed region\n"
+              << "      --simd W         auto | scalar | sse2 | avx2 | avx512 (default auto)\n"
+              << "      --nt             non-temporal (streaming) stores for write and copy\n"
+              << "      --chained        use the legacy serially-dependent xor checksum\n"
+              << "      --latency        measure load-to-use latency with a pointer chase\n"
+              << "      --page-aware     latency: visit each page fully before the next\n"
+              << "      --sweep          bandwidth and latency over growing working sets\n"
+              << "      --sweep-min SIZE smallest working set (default 4K)\n"
+              << "      --sweep-max SIZE largest working set (default --size)\n"
+              << "      --sweep-ppo N    sweep points per octave (default 2)\n"
+              << "      --loaded         latency under bandwidth load from the other threads\n"
+              << "      --probe-threads N  loaded: latency probe threads (default 1)\n"
+              << "      --inject-delays L  loaded: comma-separated spin delays per 32 KiB chunk\n"
+              << "      --scale          bandwidth at 1..--threads threads, with saturation point\n"
+              << "      --scale-steps S  scale: linear | pow2 (default linear)\n"
+              << "      --scale-tolerance P  scale: saturated within P% of peak (default 5)\n"
+              << "      --false-sharing  per-thread counters at growing distances\n"
+              << "      --fs-distances L false-sharing: comma-separated byte distances\n"
+              << "                       (default 8,16,32,64,128,256)\n"
+              << "      --gups           HPCC RandomAccess (giga-updates per second)\n"
+              << "      --gups-log2 N    GUPS table of 2^N words (default: fill --size)\n"
+              << "      --gups-verify=B  GUPS serial verification pass (default true)\n"
+              << "      --per-thread     list every thread's bytes, time and bandwidth\n"
+              << "      --counters       per-thread hardware counters (perf_event_open), IPC and\n"
+              << "                       misses per byte; software counters without PMU access\n"
+              << "      --duration T     run each bandwidth measurement for T seconds (e.g. 2, 500ms)\n"
+              << "                       instead of --iterations passes\n"
+              << "      --warmup N       untimed passes before the first trial (default 0)\n"
+              << "      --trials N       measured runs, reported with statistics (default 1)\n"
+              << "      --target-ci P    repeat trials until the 95% CI is within +-P% of the mean\n"
+              << "      --max-trials N   upper bound on trials with --target-ci (default 50)\n"
+              << "      --format F       results as text | json | csv (default text)\n"
+              << "  -o, --output FILE    write json/csv results to FILE instead of stdout\n"
+              << "      --baseline FILE  rerun the configuration of a saved json result and compare;\n"
+              << "                       exit status 2 on a regression\n"
+              << "      --regression-threshold P  baseline: fail when P% worse (default 5)\n"
+              << "  -c, --config FILE    read key = value options from FILE\n"
+              << "  -h, --help           show this help\n";
+}
+
+// Options that take no value on the command line ("--chained" means true).
+static bool is_flag(const std::string& key) {
+    return key == "random" || key == "chained" || key == "nt" ||
+           key == "latency" || key == "page-aware" || key == "sweep" || key == "loaded" ||
+           key == "pregen" || key == "gups" || key == "gups-verify" || key == "scale" ||
+           key == "false-sharing" || key == "per-thread" || key == "counters";
+}
+
+// Returns false if the program should exit successfully (e.g. after --help).
+static bool parse_args(Config& cfg, int argc, char** argv) {
+    static const struct { const char* shrt; const char* lng; } aliases[] = {
+        {"-k", "kernel"}, {"-t", "threads"}, {"-s", "size"}, {"-i", "iterations"},
+        {"-p", "pattern"}, {"-c", "config"}, {"-r", "random"}, {"-a", "affinity"},
+        {"-o", "output"},
+    };
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            print_usage(argv[0]);
+            return false;
+        }
+        std::string key, value;
+        bool has_value = false;
+        if (arg.rfind("--", 0) == 0) {
+            key = arg.substr(2);
+            const size_t eq = key.find('=');
+            if (eq != std::string::npos) {
+                value = key.substr(eq + 1);
+                key.resize(eq);
+                has_value = true;
+            }
+        } else {
+            for (const auto& a : aliases)
+                if (arg == a.shrt) key = a.lng;
+            if (key.empty()) throw std::invalid_argument("unknown option: " + arg);
+        }
+        if (!has_value && is_flag(key)) {
+            value = "true";
+        } else if (!has_value) {
+            if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+            value = argv[++i];
+        }
+        apply_option(cfg, key, value);
+    }
+    validate_config(cfg);
+    return true;
+}
 
-struct ThreadResult {
-    std::uint64_t bytes_processed = 0;
-    std::uint64_t checksum = 0; // prevent optimizing away
+// Swallows everything; stands in for stdout while --format json/csv owns it.
+struct NullBuffer : std::streambuf {
+    int overflow(int c) override { return c; }
 };
 
 int main(int argc, char** argv) {
-    // Parse mode
-    bool random_access = false;
-    for (int i = 1; i < argc; ++i) {
-        if (std::string(argv[i]) == "-r" || std::string(argv[i]) == "--random") {
-            random_access = true;
+    // Parse options
+    Config cfg;
+    try {
+        if (!parse_args(cfg, argc, argv)) return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n"
+                  << "Run with --help for usage.\n";
+        return 1;
+    }
+
+    // A json/csv document written to stdout replaces the text report; the
+    // --output file is opened up front so a bad path fails before the run
+    std::ofstream report_file;
+    if (!cfg.output.empty()) {
+        report_file.open(cfg.output);
+        if (!report_file) {
+            std::cerr << "Error: cannot write " << cfg.output << ": " << std::strerror(errno) << "\n";
+            return 1;
         }
     }
+    std::ostream report(cfg.output.empty() ? std::cout.rdbuf() : report_file.rdbuf());
+    NullBuffer null_buffer;
+    struct RestoreCout {
+        std::streambuf* buf;
+        ~RestoreCout() { std::cout.rdbuf(buf); }
+    } restore_cout{std::cout.rdbuf()};
+    if (cfg.format != Format::Text && cfg.output.empty()) std::cout.rdbuf(&null_buffer);
+
+    // Resolve the kernel and the SIMD level; only kernels with an explicit
+    // vector path use it
+    const KernelInfo& kernel = kernel_info(cfg.kernel);
+    const Simd simd = cfg.simd == Simd::Auto ? detect_simd() : cfg.simd;
+    const bool use_simd = !cfg.latency && !cfg.gups && (kernel.flags & KERNEL_SIMD) && !cfg.random_access &&
+                          !(cfg.chained && (kernel.flags & KERNEL_CHAINED));
+    // The access-width kernels bring their own instruction set instead
+    const bool fixed_isa = !cfg.latency && !cfg.gups && kernel.isa != Simd::Scalar;
+    // Scaling numbers are only meaningful with pinned threads, and loaded
+    // latency needs probes and loaders kept off each other's cores
+#if defined(__linux__)
+    if ((cfg.scale || cfg.loaded) && cfg.affinity == Affinity::None) cfg.affinity = Affinity::Scatter;
+#endif
+
+    Runtime rt;
+    rt.kernel = &kernel;
+    rt.vec = simd_kernels(use_simd ? simd : Simd::Scalar);
+    try {
+        rt.cpus = plan_affinity(cfg);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
 
     // Info banner
     std::cout << "Memory Stress Test\n"
               << "------------------\n"
-              << "Buffer size    : " << BUFFER_SIZE << " bytes\n"
-              << "Iterations     : " << ITERATIONS << "\n"
-              << "Threads        : " << NUM_THREADS << "\n"
-              << "Access pattern : " << (random_access ? "Random" : "Sequential") << "\n\n";
-
-    // Allocate big buffer as 64-bit words (helps throughput)
-    const size_t words = BUFFER_SIZE / sizeof(std::uint64_t);
-    if (words == 0) {
-        std::cerr << "BUFFER_SIZE too small.\n";
+              << "Buffer size    : " << cfg.buffer_size << " bytes\n";
+    if (cfg.duration > 0)
+        std::cout << "Duration       : " << cfg.duration << " s\n";
+    else if (!cfg.gups)
+        std::cout << "Iterations     : " << cfg.iterations << "\n";
+    std::cout << "Threads        : " << cfg.threads << "\n"
+              << "Access pattern : ";
+    const unsigned gups_log2 = cfg.gups_log2 ? static_cast<unsigned>(cfg.gups_log2)
+                                             : gups_default_log2(cfg.buffer_size);
+    if (cfg.gups) {
+        std::cout << "Random updates (HPCC RandomAccess, table[r & mask] ^= r)\n"
+                  << "GUPS table     : 2^" << gups_log2 << " words ("
+                  << format_size(sizeof(std::uint64_t) << gups_log2) << "), "
+                  << (4ull << gups_log2) << " updates\n"
+                  << "Verification   : " << (cfg.gups_verify ? "on" : "off") << "\n";
+    } else if (cfg.latency) {
+        std::cout << "Pointer chase (random cycle" << (cfg.page_aware ? ", page-aware" : "") << ")\n"
+                  << "Kernel         : chase (p = buf[p])\n";
+    } else {
+        std::cout << (cfg.random_access ? "Random" : "Sequential");
+        if (cfg.random_access)
+            std::cout << " (" << rng_name(cfg.rng) << (cfg.pregen ? ", pre-generated indices" : "") << ")";
+        std::cout << "\n"
+                  << "Kernel         : " << kernel.name << " (" << kernel.formula << ")"
+                  << (cfg.chained && (kernel.flags & KERNEL_CHAINED) ? " [chained checksum]" : "") << "\n";
+    }
+    if (!cfg.gups) {
+        std::cout << "SIMD           : ";
+        if (use_simd)
+            std::cout << simd_name(simd) << " (" << simd_bits(simd) << "-bit"
+                      << (cfg.simd == Simd::Auto ? ", auto-detected" : "") << ")"
+                      << (cfg.nt_stores ? ", non-temporal stores" : "") << "\n";
+        else if (fixed_isa)
+            std::cout << simd_name(kernel.isa) << " (" << simd_bits(kernel.isa) << "-bit, fixed by the kernel)\n";
+        else
+            std::cout << "n/a (compiler-generated loop)\n";
+    }
+    const NumaTopology numa = read_numa_topology();
+
+    std::cout << "Affinity       : " << affinity_name(cfg.affinity);
+    if (!rt.cpus.empty()) {
+        std::cout << " (thread->CPU";
+        for (size_t t = 0; t < rt.cpus.size(); ++t) std::cout << " " << t << ":" << rt.cpus[t];
+        std::cout << ")";
+    }
+    std::cout << "\n"
+              << "NUMA           : " << numa_name(cfg.numa) << ", " << numa.nodes.size() << " node(s)";
+    if (cfg.numa == Numa::Remote && numa.nodes.size() == 1)
+        std::cout << " (single node: remote placement is local)";
+    if (!rt.cpus.empty()) {
+        std::cout << " (thread->node";
+        for (size_t t = 0; t < rt.cpus.size(); ++t) std::cout << " " << t << ":" << numa.node_of(rt.cpus[t]);
+        std::cout << ")";
+    }
+    std::cout << "\n";
+    if (cfg.loaded)
+        std::cout << "Loaded latency : " << cfg.probe_threads << " probe thread(s), "
+                  << cfg.threads - cfg.probe_threads << " load thread(s), "
+                  << (rt.cpus.empty() ? "unpinned" : std::string(affinity_name(cfg.affinity)) + " placement") << "\n";
+    if (cfg.false_sharing)
+        std::cout << "False sharing  : " << cfg.threads << " counters, "
+                  << FS_INCREMENTS * static_cast<std::uint64_t>(cfg.iterations) << " increments each\n";
+    if (cfg.scale)
+        std::cout << "Scaling        : 1.." << cfg.threads << " threads, "
+                  << (cfg.scale_pow2 ? "powers of two" : "linear") << "\n";
+    if (cfg.target_ci > 0)
+        std::cout << "Trials         : until 95% CI within +-" << cfg.target_ci << "% ("
+                  << std::max(cfg.trials, 2) << ".." << cfg.max_trials << " trials)";
+    else if (cfg.trials > 1)
+        std::cout << "Trials         : " << cfg.trials;
+    if (cfg.target_ci > 0 || cfg.trials > 1)
+        std::cout << (cfg.warmup > 0 ? ", " + std::to_string(cfg.warmup) + " warmup passes\n" : std::string("\n"));
+    else if (cfg.warmup > 0)
+        std::cout << "Warmup         : " << cfg.warmup << " passes\n";
+    if (cfg.sweep)
+        std::cout << "Sweep          : " << format_size(cfg.sweep_min) << " .. "
+                  << format_size(cfg.sweep_max ? cfg.sweep_max : cfg.buffer_size)
+                  << ", " << cfg.sweep_ppo << " points per octave\n";
+    if (cfg.counters) {
+        // Probe on this thread which counters the workers will get
+        CounterSet probe;
+        rt.counters = probe.open();
+        std::cout << "Counters       : ";
+        if (!rt.counters)
+            std::cout << "unavailable (" << probe.error() << ")\n";
+        else if (probe.hardware())
+            std::cout << "hardware, per thread\n";
+        else
+            std::cout << "software only (no PMU access: " << probe.hardware_error() << ")\n";
+    }
+    std::cout << "\n";
+
+    // The false-sharing mode only needs its counters
+    if (cfg.false_sharing) {
+        std::cout << std::fixed << std::setprecision(2);
+        run_false_sharing(cfg, rt);
+        return 0;
+    }
+
+    // Allocate big buffer as 64-bit words (helps throughput). STREAM kernels
+    // get three separate arrays of the same size instead; the sweep and the
+    // loaded-latency mode need both since they also run the pointer chase.
+    // Pages are placed and initialised by the workers, not this thread.
+    const bool   stream_kernel = (kernel.flags & KERNEL_STREAM) != 0;
+    const size_t alloc_bytes = cfg.sweep && cfg.sweep_max ? cfg.sweep_max : cfg.buffer_size;
+    const size_t words = alloc_bytes / sizeof(std::uint64_t);
+
+    // With --prefault populate, mmap() faults every page in on this thread
+    // and the allocation itself is the first-touch phase
+    const bool populate = cfg.prefault == Prefault::Populate;
+    const std::uint64_t alloc_faults = thread_faults();
+    const auto alloc_start = Clock::now();
+    Buffers bufs;
+    try {
+        bufs.buf = PageArray<std::uint64_t>(stream_kernel && !cfg.sweep && !cfg.loaded && !cfg.gups ? 0 : words, cfg.pages, populate);
+        bufs.a = PageArray<double>(stream_kernel ? words : 0, cfg.pages, populate);
+        bufs.b = PageArray<double>(stream_kernel ? words : 0, cfg.pages, populate);
+        bufs.c = PageArray<double>(stream_kernel ? words : 0, cfg.pages, populate);
+    } catch (const std::bad_alloc&) {
+        std::cerr << "Error: could not allocate " << format_size(alloc_bytes) << " buffers\n";
         return 1;
     }
+    Measurement first_touch;
+    if (populate) {
+        ThreadResult r;
+        r.started = alloc_start;
+        r.finished = Clock::now();
+        r.seconds = std::chrono::duration<double>(r.finished - r.started).count();
+        r.bytes_processed = bufs.buf.bytes() + bufs.a.bytes() + bufs.b.bytes() + bufs.c.bytes();
+        r.faults = thread_faults() - alloc_faults;
+        first_touch.seconds = r.seconds;
+        first_touch.bytes = r.bytes_processed;
+        first_touch.faults = r.faults;
+        first_touch.threads.push_back(r);
+    }
+    const Measurement placed = place_buffers(cfg, rt, numa, bufs);
+    if (!populate) first_touch = placed;
 
-    std::vector<std::uint64_t> buf(words, 0);
-
-    // Partition work per thread
-    const size_t words_per_thread = (words + NUM_THREADS - 1) / NUM_THREADS;
-
-    // Thread coordination
-    StartGate gate;
-    std::vector<std::thread> threads;
-    std::vector<ThreadResult> results(NUM_THREADS);
-
-    // Work lambda
-    auto worker = [&](int tid) {
-        const size_t begin = std::min(words, static_cast<size_t>(tid) * words_per_thread);
-        const size_t end   = std::min(words, begin + words_per_thread);
-        if (begin >= end) return;
-
-        // Simple PRNG per thread for random indices
-        std::mt19937_64 rng(0xC0FFEEu ^ (static_cast<std::uint64_t>(tid) << 32));
-        std::uniform_int_distribution<size_t> dist(begin, end - 1);
-
-        // Wait for synchronized start
-        gate.wait();
-
-        std::uint64_t local_sum = 0;
-        std::uint64_t bytes = 0;
-
-        // Main loop
-        for (int it = 0; it < ITERATIONS; ++it) {
-            if (!random_access) {
-                // Sequential pass over [begin, end)
-                for (size_t i = begin; i < end; ++i) {
-                    // Read
-                    std::uint64_t v = buf[i];
-                    local_sum += (v ^ (local_sum << 1));
-                    // Write (simple mixing)
-                    buf[i] = v ^ 0xA5A5A5A5A5A5A5A5ull;
-                }
-                bytes += (end - begin) * sizeof(std::uint64_t) * 2ull; // read + write
-            } else {
-                // Random accesses of equal count
-                const size_t cnt = (end - begin);
-                for (size_t k = 0; k < cnt; ++k) {
-                    const size_t i = dist(rng);
-                    std::uint64_t v = buf[i];
-                    local_sum += (v + 0x9E3779B97F4A7C15ull);
-                    buf[i] = v ^ 0xDEADBEEFCAFEBABEull;
-                }
-                bytes += cnt * sizeof(std::uint64_t) * 2ull;
+    RunRecord rec;
+    rec.first_touch = first_touch;
+    rec.simd_used = use_simd || fixed_isa;
+    rec.simd = use_simd ? simd : kernel.isa;
+    if (bufs.buf.size() > 0) {
+        rec.backing = read_page_backing(bufs.buf.data(), bufs.buf.bytes());
+        rec.pages_obtained = bufs.buf.pages();
+    } else {
+        rec.backing = read_page_backing(bufs.a.data(), bufs.a.bytes());
+        rec.pages_obtained = bufs.a.pages();
+    }
+
+    // Compares with --baseline, writes the --format document and picks the
+    // exit status: `status` if already failing, 1 on errors, 2 on a
+    // regression
+    auto finish = [&](int status) {
+        bool ok = true;
+        if (!cfg.baseline.empty()) {
+            try {
+                ok = report_baseline(cfg, rec);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << "\n";
+                return 1;
             }
         }
-
-        results[tid].bytes_processed = bytes;
-        results[tid].checksum = local_sum; // make side effects observable
+        if (!write_report(report, cfg, rt, numa, rec)) return 1;
+        return status != 0 ? status : ok ? 0 : 2;
     };
 
-    // Launch threads
-    threads.reserve(NUM_THREADS);
-    for (int t = 0; t < NUM_THREADS; ++t) {
-        threads.emplace_back(worker, t);
+    std::cout << std::fixed << std::setprecision(2);
+    print_page_backing(cfg, rec.backing, rec.pages_obtained);
+    print_first_touch(cfg, first_touch);
+    std::cout << "\n";
+    if (cfg.sweep) {
+        run_sweep(cfg, rt, bufs);
+        return 0;
+    }
+    if (cfg.loaded) {
+        run_loaded(cfg, rt, bufs, words);
+        return 0;
+    }
+    if (cfg.scale) {
+        run_scale(cfg, rt, bufs, words);
+        return 0;
     }
+    if (cfg.gups) {
+        const Measurement m = run_gups(cfg, rt, bufs, gups_log2);
+        const double gups = m.seconds > 0 ? static_cast<double>(m.accesses) / m.seconds / 1e9 : 0.0;
+        std::cout << "Total updates         : " << m.accesses << "\n";
+        std::cout << "Elapsed time          : " << m.seconds << " s\n";
+        print_start_timing(m);
+        std::cout << std::setprecision(6);
+        std::cout << "GUP/s                 : " << gups << "\n";
+        std::cout << std::setprecision(2);
+        print_counters(m, static_cast<double>(m.accesses), "update");
+        rec.mode = "gups";
+        rec.trials = {m};
+        rec.gups = gups;
+        rec.gups_log2 = gups_log2;
+        if (!cfg.gups_verify) return finish(0);
 
-    // Start timer and release gate
-    auto t0 = Clock::now();
-    gate.release();
+        const std::uint64_t errors = gups_verify(bufs, gups_log2);
+        const double fraction = static_cast<double>(errors) / static_cast<double>(1ull << gups_log2);
+        const bool passed = fraction <= GUPS_ERROR_TOLERANCE;
+        std::cout << "Verification          : " << errors << " errors (" << fraction * 100.0 << "%), "
+                  << (passed ? "PASSED" : "FAILED") << "\n";
+        rec.gups_errors = static_cast<long long>(errors);
+        return finish(passed ? 0 : 1);
+    }
 
-    // Join
-    for (auto& th : threads) th.join();
-    auto t1 = Clock::now();
+    if (cfg.latency) {
+        // Each thread walks its share of the lines once per iteration
+        const size_t lines = words / (CACHE_LINE / sizeof(std::uint64_t));
+        const size_t steps = std::max<size_t>(1, lines / cfg.threads) * cfg.iterations;
+        const Measurement m = run_latency(cfg, rt, bufs, words, steps);
 
-    // Aggregate results
-    std::uint64_t total_bytes = 0;
-    std::uint64_t total_checksum = 0;
-    for (const auto& r : results) {
-        total_bytes += r.bytes_processed;
-        total_checksum ^= r.checksum; // combine so it's not optimized away
+        std::cout << "Total accesses        : " << m.accesses << "\n";
+        std::cout << "Elapsed time          : " << m.seconds << " s\n";
+        print_start_timing(m);
+        std::cout << "Latency               : " << m.ns_per_access() << " ns/access\n";
+        print_counters(m, static_cast<double>(m.accesses), "access");
+        std::cout << "Checksum              : 0x" << std::hex << m.checksum << std::dec << "\n";
+        rec.mode = "latency";
+        rec.trials = {m};
+        rec.latency_ns = m.ns_per_access();
+        return finish(0);
     }
 
-    std::chrono::duration<double> sec = t1 - t0;
-    const double seconds = sec.count();
-    const double mb = static_cast<double>(total_bytes) / (1024.0 * 1024.0);
-    const double mbps = seconds > 0 ? (mb / seconds) : 0.0;
+    // Repeated trials report the run with the median throughput below
+    // their statistics
+    rec.mode = "bandwidth";
+    if (cfg.trials > 1 || cfg.warmup > 0 || cfg.target_ci > 0) {
+        rec.trials = run_trials(cfg, rt, bufs, words);
+        rec.reported = median_trial(rec.trials);
+        print_trials(cfg, rec.trials);
+        if (rec.trials.size() > 1) std::cout << "Median trial\n";
+    } else {
+        rec.trials = {run_bandwidth(cfg, rt, bufs, words, cfg.iterations, cfg.duration)};
+    }
+    const Measurement& m = rec.trials[rec.reported];
 
     // Report
-    std::cout << std::fixed << std::setprecision(2);
-    std::cout << "Total bytes processed : " << static_cast<long double>(total_bytes) << " bytes\n";
-    std::cout << "Elapsed time          : " << seconds << " s\n";
-    std::cout << "Throughput            : " << mbps << " MB/s\n";
-    std::cout << "Checksum              : 0x" << std::hex << total_checksum << std::dec << "\n";
+    std::cout << "Total bytes processed : " << static_cast<long double>(m.bytes) << " bytes\n";
+    std::cout << "Elapsed time          : " << m.seconds << " s\n";
+    print_start_timing(m);
+    std::cout << "Throughput            : " << m.mbps() << " MB/s\n";
+    if (cfg.nt_stores)
+        std::cout << "Throughput incl. RFO  : " << m.rfo_mbps() << " MB/s (non-temporal stores, no RFO)\n";
+    else if (kernel.rfo > 0)
+        std::cout << "Throughput incl. RFO  : " << m.rfo_mbps() << " MB/s\n";
+    print_counters(m, static_cast<double>(m.bytes), "byte");
+    std::cout << "Checksum              : 0x" << std::hex << m.checksum << std::dec << "\n";
+    print_thread_balance(cfg, rt, m);
 
-    return 0;
+    return finish(0);
 }